@@ -0,0 +1,268 @@
+#ifndef BEACH_GENERATOR_H
+#define BEACH_GENERATOR_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <parallel.h>
+
+// 沙滩剖面参数。距离以高度场样本为单位，高度为归一化值（0~1，对应 8 位高度图的 0~255）
+// 默认值沿用 src/generate_hm.py 的剖面：深海 - 浅水 - 沙滩 - 内陆
+struct BeachProfileParams
+{
+    float shoreZ = 200.0f;          // 海岸线基准位置（样本 z）
+    bool seaTowardPositiveZ = false;  // 海在 z 更大的一侧；默认与 generate_hm.py 相同，z 更小的一侧是海
+    float shallowWidth = 40.0f;     // 浅水区宽度
+    float beachWidth = 80.0f;       // 沙滩宽度
+    float seabedWidth = 160.0f;     // 深海从浅水区外缘降到海床的距离
+
+    // 海岸线的正弦层：(振幅, 波长, 相位)，振幅和波长以样本为单位
+    glm::vec3 shoreWaves[3] = {
+        glm::vec3(30.0f, 256.0f, 0.0f),
+        glm::vec3(15.0f, 102.4f, 0.785398f),
+        glm::vec3(8.0f, 51.2f, 1.570796f)
+    };
+    float shoreNoiseAmplitude = 24.0f;      // fBm 扰动海岸线，大范围内看不出正弦的周期
+    float shoreNoiseScale = 1.0f / 512.0f;
+
+    float seabedHeight = 0.0f;
+    float shallowHeight = 50.0f / 255.0f;   // 浅水区外缘
+    float shoreHeight = 70.0f / 255.0f;     // 海岸线
+    float beachTopHeight = 200.0f / 255.0f; // 沙滩与内陆交界
+    float maxHeight = 1.0f;
+
+    float duneAmplitude = 15.0f / 255.0f;   // 沙滩中段的沙丘
+    float duneScale = 1.0f / 48.0f;
+    float rippleAmplitude = 3.0f / 255.0f;  // 浅水区的水下沙纹
+    float rippleWavelength = 6.0f;
+    float sandNoiseAmplitude = 4.0f / 255.0f;  // 沙面的细碎起伏
+    float sandNoiseScale = 1.0f / 3.0f;
+    float inlandRoughness = 15.0f / 255.0f; // 内陆的地形变化
+    int octaves = 5;
+};
+
+// 无查表的 2D 单形噪声：梯度由坐标的整数哈希选出，没有排列表也没有分支，
+// 逐样本循环可以被编译器展开/向量化；同一种子在任何平台上结果一致
+namespace BeachNoise
+{
+    inline uint32_t Hash(int32_t i, int32_t j, uint32_t seed)
+    {
+        uint32_t h = static_cast<uint32_t>(i) * 0x8da6b343u ^ static_cast<uint32_t>(j) * 0xd8163841u ^ seed * 0xcb1ab31fu;
+        h ^= h >> 16;
+        h *= 0x7feb352du;
+        h ^= h >> 15;
+        h *= 0x846ca68bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    // 8 个方向 (±1, ±2) / (±2, ±1)；用算术代替条件选择，哈希位是随机的，分支必然预测失败
+    inline float Grad(uint32_t h, float x, float y)
+    {
+        float swap = static_cast<float>(static_cast<int32_t>((h >> 2) & 1u));
+        float u = x + (y - x) * swap;
+        float v = y + (x - y) * swap;
+        float su = 1.0f - 2.0f * static_cast<float>(static_cast<int32_t>(h & 1u));
+        float sv = 2.0f - 4.0f * static_cast<float>(static_cast<int32_t>((h >> 1) & 1u));
+        return su * u + sv * v;
+    }
+
+    // v < 0 时为 1，否则为 0。直接取符号位，不产生比较分支：
+    // 不开 -ffast-math 时编译器不会把浮点比较/std::max 转成条件选择，循环就无法向量化
+    inline float NegativeMask(float v)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return static_cast<float>(static_cast<int32_t>(bits >> 31));
+    }
+
+    inline float FastFloor(float x)
+    {
+        float t = static_cast<float>(static_cast<int32_t>(x));
+        return t - NegativeMask(x - t);
+    }
+
+    inline float PositivePart(float v)
+    {
+        return v * (1.0f - NegativeMask(v));
+    }
+
+    // 输出约在 [-1, 1]
+    inline float Simplex2(float x, float y, uint32_t seed)
+    {
+        const float F2 = 0.36602540378f;
+        const float G2 = 0.21132486540f;
+
+        float s = (x + y) * F2;
+        float fi = FastFloor(x + s);
+        float fj = FastFloor(y + s);
+        float t = (fi + fj) * G2;
+        float x0 = x - (fi - t);
+        float y0 = y - (fj - t);
+
+        float i1 = NegativeMask(y0 - x0);
+        float j1 = 1.0f - i1;
+        float x1 = x0 - i1 + G2, y1 = y0 - j1 + G2;
+        float x2 = x0 - 1.0f + 2.0f * G2, y2 = y0 - 1.0f + 2.0f * G2;
+
+        int32_t i = static_cast<int32_t>(fi), j = static_cast<int32_t>(fj);
+        uint32_t h0 = Hash(i, j, seed);
+        uint32_t h1 = Hash(i + static_cast<int32_t>(i1), j + static_cast<int32_t>(j1), seed);
+        uint32_t h2 = Hash(i + 1, j + 1, seed);
+
+        float t0 = PositivePart(0.5f - x0 * x0 - y0 * y0);
+        float t1 = PositivePart(0.5f - x1 * x1 - y1 * y1);
+        float t2 = PositivePart(0.5f - x2 * x2 - y2 * y2);
+        t0 *= t0; t1 *= t1; t2 *= t2;
+        return 45.0f * (t0 * t0 * Grad(h0, x0, y0) + t1 * t1 * Grad(h1, x1, y1) + t2 * t2 * Grad(h2, x2, y2));
+    }
+
+    // 沿一行批量计算 fBm：out[n] = Σ amp * Simplex2((x0 + n * dx) * freq, z * freq)
+    // 外层循环是倍频，内层是样本，内层循环没有依赖，适合向量化；结果约在 [-1, 1]
+    inline void FbmRow(float x0, float dx, float z, int count, float scale, int octaves, uint32_t seed, float* out)
+    {
+        std::fill(out, out + count, 0.0f);
+        float freq = scale, amp = 0.5f, norm = 0.0f;
+        for (int o = 0; o < octaves; o++) {
+            uint32_t octaveSeed = seed + static_cast<uint32_t>(o) * 0x9e3779b9u;
+            float fz = z * freq;
+            for (int n = 0; n < count; n++)
+                out[n] += amp * Simplex2((x0 + n * dx) * freq, fz, octaveSeed);
+            norm += amp;
+            freq *= 2.0f;
+            amp *= 0.5f;
+        }
+        float inv = 1.0f / std::max(norm, 1e-6f);
+        for (int n = 0; n < count; n++) out[n] *= inv;
+    }
+}
+
+// 程序化沙滩高度场：高度只取决于种子和全局样本坐标，所以任意切分、任意顺序、
+// 任意线程生成的块在边界上完全一致，可以按需逐块生成，而不用发布整张大图。
+// 海岸线沿 X 方向延伸（正弦层 + fBm 扰动），Z 方向依次是深海、浅水（沙纹）、沙滩（沙丘）、内陆。
+// 所有方法都是 const 且无共享状态，可以被多个工作线程同时调用。
+class BeachTerrainGenerator
+{
+public:
+    explicit BeachTerrainGenerator(uint32_t seed = 42, const BeachProfileParams& params = BeachProfileParams())
+        : m_seed(seed), m_params(params)
+    {}
+
+    // 生成从样本 (x0, z0) 开始、间隔 step 的 width x height 个样本，按行写入 out
+    void GenerateRegion(int x0, int z0, int width, int height, int step, float* out) const
+    {
+        if (width <= 0 || height <= 0) return;
+        RowScratch scratch(width);
+        ShoreRow(x0, step, width, scratch);
+        for (int r = 0; r < height; r++)
+            ProfileRow(x0, z0 + r * step, step, width, scratch, &out[static_cast<size_t>(r) * width]);
+    }
+
+    // 同上，按行切给多个线程，用于一次性生成整张图（例如分页地形的代理）
+    void GenerateRegionParallel(int x0, int z0, int width, int height, int step, float* out) const
+    {
+        if (width <= 0 || height <= 0) return;
+        ParallelForRange(height, [&](int begin, int end) {
+            RowScratch scratch(width);
+            ShoreRow(x0, step, width, scratch);
+            for (int r = begin; r < end; r++)
+                ProfileRow(x0, z0 + r * step, step, width, scratch, &out[static_cast<size_t>(r) * width]);
+        }, 8);
+    }
+
+    // 块 (tileX, tileZ)：(tileQuads + 1)^2 个样本，相邻块共享边界样本
+    void GenerateTile(int tileX, int tileZ, int tileQuads, std::vector<float>& out) const
+    {
+        int size = tileQuads + 1;
+        out.resize(static_cast<size_t>(size) * size);
+        GenerateRegion(tileX * tileQuads, tileZ * tileQuads, size, size, 1, out.data());
+    }
+
+    uint32_t GetSeed() const { return m_seed; }
+    const BeachProfileParams& GetParams() const { return m_params; }
+
+private:
+    uint32_t m_seed;
+    BeachProfileParams m_params;
+
+    struct RowScratch
+    {
+        std::vector<float> shore, dune, sand;
+        explicit RowScratch(int width) : shore(width), dune(width), sand(width) {}
+    };
+
+    // 每列海岸线所在的 z，只与 x 有关，整块复用
+    void ShoreRow(int x0, int step, int width, RowScratch& scratch) const
+    {
+        const BeachProfileParams& p = m_params;
+        float* shore = scratch.shore.data();
+        BeachNoise::FbmRow(static_cast<float>(x0), static_cast<float>(step), 0.0f, width,
+                           p.shoreNoiseScale, 3, m_seed ^ 0x51u, shore);
+
+        const float TWO_PI_F = glm::two_pi<float>();
+        for (int n = 0; n < width; n++) {
+            float x = static_cast<float>(x0 + n * step);
+            float offset = p.shoreNoiseAmplitude * shore[n];
+            for (const glm::vec3& wave : p.shoreWaves)
+                offset += wave.x * std::sin(TWO_PI_F * x / wave.y + wave.z);
+            shore[n] = p.shoreZ + offset;
+        }
+    }
+
+    static float Smootherstep(float t)
+    {
+        return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+    }
+
+    // 一行的剖面：四个分区都无分支地算出来，最后按到海岸线的距离选择
+    void ProfileRow(int x0, int z, int step, int width, RowScratch& scratch, float* out) const
+    {
+        const BeachProfileParams& p = m_params;
+        float fx0 = static_cast<float>(x0), fdx = static_cast<float>(step), fz = static_cast<float>(z);
+        float* dune = scratch.dune.data();
+        float* sand = scratch.sand.data();
+        BeachNoise::FbmRow(fx0, fdx, fz, width, p.duneScale, p.octaves, m_seed, dune);
+        for (int n = 0; n < width; n++)
+            sand[n] = BeachNoise::Simplex2((fx0 + n * fdx) * p.sandNoiseScale, fz * p.sandNoiseScale, m_seed ^ 0xa3u);
+
+        const float PI_F = glm::pi<float>();
+        const float* shore = scratch.shore.data();
+        float side = p.seaTowardPositiveZ ? -1.0f : 1.0f;
+        for (int n = 0; n < width; n++) {
+            float d = (fz - shore[n]) * side;   // 到海岸线的距离，负数在海里
+
+            // 深海：从浅水区外缘降到海床
+            float deepT = glm::clamp(-(d + p.shallowWidth) / p.seabedWidth, 0.0f, 1.0f);
+            float deep = glm::mix(p.shallowHeight, p.seabedHeight, Smootherstep(deepT)) + 0.5f * p.sandNoiseAmplitude * dune[n];
+
+            // 浅水：平滑升到海岸线，叠加被噪声扭曲的沙纹，靠岸时淡出
+            float shallowT = glm::clamp((d + p.shallowWidth) / p.shallowWidth, 0.0f, 1.0f);
+            float ripple = std::sin(2.0f * PI_F * (d + 4.0f * sand[n]) / p.rippleWavelength);
+            float shallow = glm::mix(p.shallowHeight, p.shoreHeight, Smootherstep(shallowT))
+                          + p.rippleAmplitude * ripple * (1.0f - shallowT * shallowT);
+
+            // 沙滩：平滑升到内陆，中段叠加沙丘
+            float beachT = glm::clamp(d / p.beachWidth, 0.0f, 1.0f);
+            float duneWindow = std::sin(PI_F * glm::clamp((beachT - 0.3f) / 0.4f, 0.0f, 1.0f));
+            float beach = glm::mix(p.shoreHeight, p.beachTopHeight, Smootherstep(beachT))
+                        + p.duneAmplitude * duneWindow * (0.6f * std::sin(beachT * 4.0f * PI_F) + 0.8f * dune[n])
+                        + p.sandNoiseAmplitude * sand[n] * beachT;
+            beach = glm::clamp(beach, p.shoreHeight, p.beachTopHeight);
+
+            // 内陆：对数增长，起伏从沙滩边缘逐渐出现
+            float inlandDist = std::max(d - p.beachWidth, 0.0f);
+            float inland = p.beachTopHeight + std::log(1.0f + inlandDist * 0.1f) * (30.0f / 255.0f)
+                         + p.inlandRoughness * (0.5f + 0.5f * dune[n]) * glm::clamp(inlandDist / 16.0f, 0.0f, 1.0f);
+            inland = std::min(inland, p.maxHeight);
+
+            float h = d < -p.shallowWidth ? deep : (d < 0.0f ? shallow : (d < p.beachWidth ? beach : inland));
+            out[n] = glm::clamp(h, 0.0f, 1.0f);
+        }
+    }
+};
+
+#endif // BEACH_GENERATOR_H
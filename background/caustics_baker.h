@@ -0,0 +1,130 @@
+#ifndef CAUSTICS_BAKER_H
+#define CAUSTICS_BAKER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <iostream>
+#include <parallel.h>
+
+// 焦散烘焙：用 OceanFFTBaker 的法线把竖直入射的光子折射到水下平面上，
+// 统计落点密度得到每一帧的焦散图，存为循环的 2D 纹理数组
+// 海面 FFT 本身是周期的，光子落点按块尺寸取模后焦散图也可以无缝平铺
+// 焦散图与海面法线图共用纹理坐标（着色器里都用 causticsRect 采样），所以偏移按海面纹理一个周期
+// 实际覆盖的世界尺寸换算，而不是 FFT 的块尺寸：纹理被拉伸或平铺到整片水面时折射偏移的比例仍然正确
+class CausticsBaker
+{
+public:
+    // normals: N x N x T 的法线（与 OceanFFTBaker 的布局相同）
+    // textureSize: 海面纹理坐标 [0, 1] 在 x/z 方向覆盖的世界尺寸；depth: 接收平面在水面下的深度（世界单位）
+    CausticsBaker(const std::vector<glm::vec3>& normals, int N, int T, const glm::vec2& textureSize,
+                  int resolution = 128, float depth = 8.0f, int photonsPerTexel = 2)
+        : N(N), T(T), M(resolution), textureSize(textureSize), depth(depth), photonsPerTexel(photonsPerTexel)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        std::vector<float> density(static_cast<size_t>(M) * M * T);
+        // 各帧相互独立，按帧分给多个线程，每个线程写自己的那几层
+        ParallelFor(T, [&](int t) {
+            BakeFrame(&normals[static_cast<size_t>(t) * N * N], &density[static_cast<size_t>(t) * M * M]);
+        });
+
+        Upload(density);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "Caustics baked: " << M << "x" << M << " x " << T << " frames in "
+                  << std::chrono::duration<float, std::milli>(end - start).count() << " ms" << std::endl;
+    }
+
+    ~CausticsBaker()
+    {
+        if (texture) glDeleteTextures(1, &texture);
+    }
+
+    unsigned int GetTexture() const { return texture; }
+    int GetFrameCount() const { return T; }
+
+private:
+    int N, T, M;
+    glm::vec2 textureSize;
+    float depth;
+    int photonsPerTexel;
+    unsigned int texture = 0;
+
+    static constexpr float ETA = 1.0f / 1.33f;  // 空气 -> 水
+
+    // 周期性双线性插值法线
+    glm::vec3 SampleNormal(const glm::vec3* frame, float u, float v) const
+    {
+        float x = u * N - 0.5f;
+        float y = v * N - 0.5f;
+        int x0 = static_cast<int>(std::floor(x));
+        int y0 = static_cast<int>(std::floor(y));
+        float fx = x - x0, fy = y - y0;
+        auto at = [&](int ix, int iy) {
+            ix = ((ix % N) + N) % N;
+            iy = ((iy % N) + N) % N;
+            return frame[iy * N + ix];
+        };
+        glm::vec3 n = glm::mix(glm::mix(at(x0, y0), at(x0 + 1, y0), fx),
+                               glm::mix(at(x0, y0 + 1), at(x0 + 1, y0 + 1), fx), fy);
+        return glm::normalize(n);
+    }
+
+    void BakeFrame(const glm::vec3* frame, float* out) const
+    {
+        int P = N * photonsPerTexel;  // 每个方向的光子数
+        const glm::vec3 incident(0.0f, -1.0f, 0.0f);
+
+        for (int j = 0; j < P; j++) {
+            for (int i = 0; i < P; i++) {
+                float u = (i + 0.5f) / P;
+                float v = (j + 0.5f) / P;
+                glm::vec3 n = SampleNormal(frame, u, v);
+                glm::vec3 r = glm::refract(incident, n, ETA);
+                if (r.y >= -1e-3f) continue;
+
+                // 折射光线到达深度 depth 处平面的水平偏移，换算成纹理坐标
+                glm::vec2 offset = glm::vec2(r.x, r.z) / -r.y * depth / textureSize;
+                float px = (u + offset.x) * M - 0.5f;
+                float py = (v + offset.y) * M - 0.5f;
+
+                // 双线性泼溅，越界部分绕回另一侧
+                int x0 = static_cast<int>(std::floor(px));
+                int y0 = static_cast<int>(std::floor(py));
+                float fx = px - x0, fy = py - y0;
+                float w[4] = { (1 - fx) * (1 - fy), fx * (1 - fy), (1 - fx) * fy, fx * fy };
+                int xs[2] = { ((x0 % M) + M) % M, (((x0 + 1) % M) + M) % M };
+                int ys[2] = { ((y0 % M) + M) % M, (((y0 + 1) % M) + M) % M };
+                out[ys[0] * M + xs[0]] += w[0];
+                out[ys[0] * M + xs[1]] += w[1];
+                out[ys[1] * M + xs[0]] += w[2];
+                out[ys[1] * M + xs[1]] += w[3];
+            }
+        }
+
+        // 归一化：1 表示光照与平静水面下相同，>1 为会聚的亮纹
+        float expected = static_cast<float>(P) * P / (static_cast<float>(M) * M);
+        for (int k = 0; k < M * M; k++)
+            out[k] /= expected;
+    }
+
+    void Upload(const std::vector<float>& density)
+    {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R16F, M, M, T, 0, GL_RED, GL_FLOAT, density.data());
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+        float memoryMB = static_cast<float>(M) * M * T * 2 / (1024.0f * 1024.0f);
+        std::cout << "Caustics GPU Memory: " << memoryMB << " MB" << std::endl;
+    }
+};
+
+#endif // CAUSTICS_BAKER_H
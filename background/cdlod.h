@@ -0,0 +1,240 @@
+#ifndef CDLOD_H
+#define CDLOD_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <frustum.h>
+
+// CDLOD (Continuous Distance-Dependent LOD) 四叉树
+// 每个节点都用同一块 patch 网格绘制，节点越大网格越稀；LOD 只取决于到相机的距离，
+// 顶点着色器在每级距离范围的末尾把奇数顶点收拢到偶数顶点上，与上一级平滑过渡
+
+// 每帧选出的一个绘制单元
+struct CDLODSelection
+{
+    glm::vec3 origin;   // 节点左上角的世界坐标（y 未用）
+    float size;         // 节点边长（世界单位）
+    int level;          // 0 为最细
+    int quadrant;       // -1 画整块，0..3 只画其中一个象限（其余象限由更细的子节点负责）
+};
+
+class CDLODQuadtree
+{
+public:
+    // 顶点 (x, z) 的世界坐标为 ((x - width/2) * horizontalScale, h, (z - height/2) * horizontalScale)
+    CDLODQuadtree(const std::vector<float>& heightData, int width, int height,
+                  float heightScale, float horizontalScale,
+                  int patchQuads = 32, float baseRange = 0.0f)
+        : m_width(width), m_height(height), m_heightScale(heightScale),
+          m_horizontalScale(horizontalScale), m_patchQuads(patchQuads)
+    {
+        // 根节点覆盖整张网格，边长为 patchQuads * 2^(levels-1) 个四边形
+        m_levels = 1;
+        int rootQuads = patchQuads;
+        while (rootQuads < std::max(width - 1, height - 1)) {
+            rootQuads *= 2;
+            m_levels++;
+        }
+
+        // 每级距离范围依次翻倍；最粗一级不限距离
+        float leafSize = patchQuads * horizontalScale;
+        float range = baseRange > 0.0f ? baseRange : leafSize * 2.0f;
+        m_ranges.resize(m_levels);
+        for (int i = 0; i < m_levels; i++) {
+            m_ranges[i] = (i == m_levels - 1) ? 1e30f : range;
+            range *= 2.0f;
+        }
+
+        m_root = Build(heightData, 0, 0, rootQuads, m_levels - 1);
+
+        std::cout << "CDLOD quadtree: " << m_nodes.size() << " nodes, " << m_levels
+                  << " levels, patch " << patchQuads << "x" << patchQuads << std::endl;
+    }
+
+    // 按相机位置选择节点，frustum 为空时不做视锥剔除
+    const std::vector<CDLODSelection>& Select(const glm::vec3& cameraPos, const Frustum* frustum)
+    {
+        m_selection.clear();
+        if (m_root >= 0)
+            SelectNode(m_root, cameraPos, frustum);
+        return m_selection;
+    }
+
+    // 第 level 级的形变区间 (开始, 结束)，结束处正好到该级范围边界
+    glm::vec2 GetMorphRange(int level) const
+    {
+        float end = m_ranges[level];
+        if (level == m_levels - 1)
+            return glm::vec2(1e29f, 1e30f);  // 最粗一级不需要形变
+        float prev = level > 0 ? m_ranges[level - 1] : 0.0f;
+        return glm::vec2(prev + (end - prev) * 0.66f, end);
+    }
+
+    // 高度场中 [x0, x1] x [z0, z1]（闭区间）内的样本被修改后，只重算覆盖这些样本的节点的高度范围
+    void UpdateRegion(const std::vector<float>& heightData, int x0, int z0, int x1, int z1)
+    {
+        if (m_root >= 0)
+            UpdateNode(heightData, m_root, x0, z0, x1, z1);
+    }
+
+    int GetPatchQuads() const { return m_patchQuads; }
+    int GetLevelCount() const { return m_levels; }
+    const std::vector<CDLODSelection>& GetSelection() const { return m_selection; }
+
+private:
+    struct Node
+    {
+        int x, z, quads;    // 覆盖的网格区域（以四边形计）
+        int level;
+        float minH, maxH;   // 世界高度
+        int children[4];
+    };
+
+    int m_width, m_height;
+    float m_heightScale, m_horizontalScale;
+    int m_patchQuads;
+    int m_levels;
+    int m_root = -1;
+    std::vector<float> m_ranges;
+    std::vector<Node> m_nodes;
+    std::vector<CDLODSelection> m_selection;
+
+    int Build(const std::vector<float>& heightData, int x, int z, int quads, int level)
+    {
+        // 完全在高度图之外的节点不创建
+        if (x >= m_width - 1 || z >= m_height - 1) return -1;
+
+        Node node;
+        node.x = x;
+        node.z = z;
+        node.quads = quads;
+        node.level = level;
+        node.minH = 1e30f;
+        node.maxH = -1e30f;
+        for (int i = 0; i < 4; i++) node.children[i] = -1;
+
+        if (level == 0) {
+            int x1 = std::min(x + quads, m_width - 1);
+            int z1 = std::min(z + quads, m_height - 1);
+            for (int zz = z; zz <= z1; zz++) {
+                for (int xx = x; xx <= x1; xx++) {
+                    float h = heightData[zz * m_width + xx] * m_heightScale;
+                    node.minH = std::min(node.minH, h);
+                    node.maxH = std::max(node.maxH, h);
+                }
+            }
+        } else {
+            int half = quads / 2;
+            int children[4] = {
+                Build(heightData, x, z, half, level - 1),
+                Build(heightData, x + half, z, half, level - 1),
+                Build(heightData, x, z + half, half, level - 1),
+                Build(heightData, x + half, z + half, half, level - 1)
+            };
+            for (int i = 0; i < 4; i++) {
+                node.children[i] = children[i];
+                if (children[i] < 0) continue;
+                node.minH = std::min(node.minH, m_nodes[children[i]].minH);
+                node.maxH = std::max(node.maxH, m_nodes[children[i]].maxH);
+            }
+        }
+
+        m_nodes.push_back(node);
+        return static_cast<int>(m_nodes.size()) - 1;
+    }
+
+    void UpdateNode(const std::vector<float>& heightData, int index, int x0, int z0, int x1, int z1)
+    {
+        Node& node = m_nodes[index];
+        if (x1 < node.x || z1 < node.z || x0 > node.x + node.quads || z0 > node.z + node.quads)
+            return;
+
+        node.minH = 1e30f;
+        node.maxH = -1e30f;
+        if (node.level == 0) {
+            int nx1 = std::min(node.x + node.quads, m_width - 1);
+            int nz1 = std::min(node.z + node.quads, m_height - 1);
+            for (int zz = node.z; zz <= nz1; zz++) {
+                for (int xx = node.x; xx <= nx1; xx++) {
+                    float h = heightData[zz * m_width + xx] * m_heightScale;
+                    node.minH = std::min(node.minH, h);
+                    node.maxH = std::max(node.maxH, h);
+                }
+            }
+            return;
+        }
+
+        for (int i = 0; i < 4; i++) {
+            int child = m_nodes[index].children[i];
+            if (child < 0) continue;
+            UpdateNode(heightData, child, x0, z0, x1, z1);
+            m_nodes[index].minH = std::min(m_nodes[index].minH, m_nodes[child].minH);
+            m_nodes[index].maxH = std::max(m_nodes[index].maxH, m_nodes[child].maxH);
+        }
+    }
+
+    void GetBounds(const Node& node, glm::vec3& bmin, glm::vec3& bmax) const
+    {
+        int x1 = std::min(node.x + node.quads, m_width - 1);
+        int z1 = std::min(node.z + node.quads, m_height - 1);
+        bmin = glm::vec3((node.x - m_width / 2.0f) * m_horizontalScale, node.minH,
+                         (node.z - m_height / 2.0f) * m_horizontalScale);
+        bmax = glm::vec3((x1 - m_width / 2.0f) * m_horizontalScale, node.maxH,
+                         (z1 - m_height / 2.0f) * m_horizontalScale);
+    }
+
+    static bool IntersectsSphere(const glm::vec3& bmin, const glm::vec3& bmax,
+                                 const glm::vec3& center, float radius)
+    {
+        glm::vec3 d = center - glm::clamp(center, bmin, bmax);
+        return glm::dot(d, d) <= radius * radius;
+    }
+
+    void Add(const Node& node, int quadrant)
+    {
+        CDLODSelection sel;
+        sel.origin = glm::vec3((node.x - m_width / 2.0f) * m_horizontalScale, 0.0f,
+                               (node.z - m_height / 2.0f) * m_horizontalScale);
+        sel.size = node.quads * m_horizontalScale;
+        sel.level = node.level;
+        sel.quadrant = quadrant;
+        m_selection.push_back(sel);
+    }
+
+    // 返回 false 表示节点不在本级范围内，需要由父节点以较粗的网格覆盖
+    bool SelectNode(int index, const glm::vec3& cameraPos, const Frustum* frustum)
+    {
+        const Node& node = m_nodes[index];
+        glm::vec3 bmin, bmax;
+        GetBounds(node, bmin, bmax);
+
+        if (!IntersectsSphere(bmin, bmax, cameraPos, m_ranges[node.level]))
+            return false;
+        if (frustum && !frustum->IntersectsAABB(bmin, bmax))
+            return true;  // 不可见，也算已处理
+
+        if (node.level == 0 || !IntersectsSphere(bmin, bmax, cameraPos, m_ranges[node.level - 1])) {
+            Add(node, -1);
+            return true;
+        }
+
+        bool childHandled[4];
+        bool all = true;
+        for (int i = 0; i < 4; i++) {
+            childHandled[i] = node.children[i] < 0 || SelectNode(node.children[i], cameraPos, frustum);
+            all = all && childHandled[i];
+        }
+        if (!all) {
+            for (int i = 0; i < 4; i++) {
+                if (!childHandled[i])
+                    Add(node, i);
+            }
+        }
+        return true;
+    }
+};
+
+#endif // CDLOD_H
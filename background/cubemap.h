@@ -8,6 +8,10 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #endif
+#include <mapped_file.h>
+#include <content_hash.h>
+#include <texture_cache.h>
+#include <image_decode.h>
 using namespace std;
 class CubemapTexture
 // 用于加载和绑定立方体贴图
@@ -32,7 +36,7 @@ public:
 
     ~CubemapTexture()
     {
-        glDeleteTextures(1, &m_textureObj);
+        TextureCache::Instance().Release(m_textureObj);
     }
 
     bool Load();//上传到gpu，并保存ID
@@ -42,34 +46,52 @@ public:
 private:
 
     string m_fileNames[6];
-    GLuint m_textureObj;
+    GLuint m_textureObj = 0;
 };
 bool CubemapTexture::Load()
 {
+    // 六个面的内容一起作为共享缓存的键，同一套天空盒只上传一次
+    MappedFile files[6];
+    TextureCache::Sampler sampler = { GL_TEXTURE_CUBE_MAP, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_LINEAR, GL_LINEAR };
+    uint64_t key = ContentHash::Hash(&sampler, sizeof(sampler));
+    for (unsigned int i = 0 ; i < 6 ; i++) {
+        if (!files[i].Open(m_fileNames[i])) {
+            std::cout << "Cubemap texture failed to load at path: " << m_fileNames[i] << std::endl;
+            return false;
+        }
+        key = ContentHash::Hash(files[i].Data(), files[i].Size(), key);
+    }
+    m_textureObj = TextureCache::Instance().Acquire(key);
+    if (m_textureObj != 0)
+        return true;
+
+    // 六个面并行解码，GL 线程只上传
+    ImageDecodeBatch batch;
+    for (unsigned int i = 0 ; i < 6 ; i++)
+        batch.Add(m_fileNames[i], files[i].Data(), files[i].Size());
+    batch.Decode();
+
     glGenTextures(1, &m_textureObj);
     glBindTexture(GL_TEXTURE_CUBE_MAP, m_textureObj);
 
+    size_t bytes = 0;
     for (unsigned int i = 0 ; i < 6 ; i++) {
-        int width, height, nrChannels;
-        unsigned char *data = stbi_load(m_fileNames[i].c_str(), &width, &height, &nrChannels, 0);
-        if (!data)
+        if (!batch.Upload(i, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i))
         {
             std::cout << "Cubemap texture failed to load at path: " << m_fileNames[i] << std::endl;
-            stbi_image_free(data);
             return false;
         }
-        GLenum format = (nrChannels == 3) ? GL_RGB : GL_RGBA;
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format,
-            GL_UNSIGNED_BYTE, data);
-        
-        stbi_image_free(data);//释放图像内存
+        const ImageDecodeBatch::Image& image = batch.Get(i);
+        bytes += TextureCache::EstimateBytes(image.width, image.height, image.channels, false);
     } 
+    batch.Report("Cubemap textures");
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);//GL_CLAMP_TO_EDGE 纹理坐标超出范围时，使用边缘颜色
 
+    m_textureObj = TextureCache::Instance().Insert(key, m_textureObj, bytes);
     return true;
 }
 void CubemapTexture::Bind(GLenum TextureUnit)
@@ -0,0 +1,80 @@
+#ifndef HEIGHTFIELD_NORMALS_H
+#define HEIGHTFIELD_NORMALS_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <algorithm>
+#include <parallel.h>
+
+// 规则网格高度场的法线/切线/副切线：直接由高度的中心差分解析得到，
+// 不需要遍历三角形。按行切给多个线程，每个顶点只写一次，没有分散累加。
+//
+// 网格约定与 Terrain 相同：顶点 (x, z) 位于 (x * horizontalScale, h * heightScale, z * horizontalScale)，
+// 纹理坐标 u 沿 +X、v 沿 +Z 增长，所以切线为 dP/dx、副切线为 dP/dz。
+// write(index, normal, tangent, bitangent) 在工作线程中调用，index = z * width + x。
+//
+// 区域版本只计算 [x0, x1] x [z0, z1]（闭区间）内的顶点，代价与区域面积成正比，
+// 用于地形局部形变后的增量更新；区域外的高度照常参与差分。
+template <typename Writer>
+void ComputeHeightfieldFramesRegion(const std::vector<float>& heights, int width, int height,
+                                    float heightScale, float horizontalScale,
+                                    int x0, int z0, int x1, int z1, Writer write)
+{
+    x0 = std::max(x0, 0);
+    z0 = std::max(z0, 0);
+    x1 = std::min(x1, width - 1);
+    z1 = std::min(z1, height - 1);
+    if (x0 > x1 || z0 > z1) return;
+    int count = x1 - x0 + 1;
+
+    ParallelForRange(z1 - z0 + 1, [&](int begin, int end) {
+        // 每段复用的斜率缓冲：先整行算出斜率（无分支，便于编译器向量化），再统一归一化写出
+        std::vector<float> dhdx(count), dhdz(count);
+
+        for (int z = z0 + begin; z < z0 + end; z++) {
+            int zDown = std::max(z - 1, 0);
+            int zUp = std::min(z + 1, height - 1);
+            const float* row = &heights[static_cast<size_t>(z) * width];
+            const float* down = &heights[static_cast<size_t>(zDown) * width];
+            const float* up = &heights[static_cast<size_t>(zUp) * width];
+
+            // 边界行/列退化为单侧差分，步长按实际跨度计算
+            float invDz = zUp > zDown ? heightScale / ((zUp - zDown) * horizontalScale) : 0.0f;
+            for (int i = 0; i < count; i++)
+                dhdz[i] = (up[x0 + i] - down[x0 + i]) * invDz;
+
+            if (width > 1) {
+                float invDx2 = heightScale / (2.0f * horizontalScale);
+                float invDx1 = heightScale / horizontalScale;
+                int inner0 = std::max(x0, 1), inner1 = std::min(x1, width - 2);
+                for (int x = inner0; x <= inner1; x++)
+                    dhdx[x - x0] = (row[x + 1] - row[x - 1]) * invDx2;
+                if (x0 == 0)
+                    dhdx[0] = (row[1] - row[0]) * invDx1;
+                if (x1 == width - 1)
+                    dhdx[count - 1] = (row[width - 1] - row[width - 2]) * invDx1;
+            } else {
+                dhdx[0] = 0.0f;
+            }
+
+            size_t rowStart = static_cast<size_t>(z) * width + x0;
+            for (int i = 0; i < count; i++) {
+                glm::vec3 normal = glm::normalize(glm::vec3(-dhdx[i], 1.0f, -dhdz[i]));
+                glm::vec3 tangent = glm::vec3(1.0f, dhdx[i], 0.0f);
+                tangent = glm::normalize(tangent - normal * glm::dot(normal, tangent));
+                glm::vec3 bitangent = glm::normalize(glm::vec3(0.0f, dhdz[i], 1.0f));
+                write(rowStart + i, normal, tangent, bitangent);
+            }
+        }
+    }, 16);
+}
+
+template <typename Writer>
+void ComputeHeightfieldFrames(const std::vector<float>& heights, int width, int height,
+                              float heightScale, float horizontalScale, Writer write)
+{
+    ComputeHeightfieldFramesRegion(heights, width, height, heightScale, horizontalScale,
+                                   0, 0, width - 1, height - 1, write);
+}
+
+#endif // HEIGHTFIELD_NORMALS_H
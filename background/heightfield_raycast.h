@@ -0,0 +1,261 @@
+#ifndef HEIGHTFIELD_RAYCAST_H
+#define HEIGHTFIELD_RAYCAST_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <parallel.h>
+
+// 高度场射线求交（鼠标拾取等）
+//
+// 在高度图上建一棵 min/max 四叉树（mip 金字塔）：第 L 层每个节点覆盖 2^L x 2^L 个格子，
+// 记录其中的最低/最高高度。射线自顶向下、按由近到远的顺序访问子节点，包围盒不相交的
+// 整块直接跳过；到单个格子时把格子看成双线性曲面 h(u,v)，与射线求二次方程的精确交点。
+// 按由近到远的顺序访问，找到的第一个交点就是最近的交点。
+//
+// 第 0 层（单个格子）的包围盒由四个角现算，金字塔只存第 1 层以上，内存约为高度图的一半。
+// 坐标约定与 Terrain 相同；heights 需要在本对象存活期间保持有效（不复制）。
+class HeightfieldRayCaster
+{
+public:
+    HeightfieldRayCaster(const std::vector<float>& heights, int width, int height,
+                         float heightScale, float horizontalScale)
+        : m_heights(heights), m_width(width), m_height(height),
+          m_heightScale(heightScale), m_horizontalScale(horizontalScale)
+    {
+        m_originX = -width / 2.0f * horizontalScale;
+        m_originZ = -height / 2.0f * horizontalScale;
+        m_cellsX = std::max(width - 1, 1);
+        m_cellsZ = std::max(height - 1, 1);
+        BuildPyramid();
+    }
+
+    // 与射线 origin + t * dir（dir 无需归一化）求最近交点，t 的范围为 [0, maxT]
+    bool Raycast(const glm::vec3& origin, const glm::vec3& dir, float maxT,
+                 glm::vec3& hitPoint, float* hitT = nullptr) const
+    {
+        // 转到网格空间：x/z 以格子为单位，y 仍为世界高度，参数 t 与世界空间一致
+        Ray ray;
+        ray.o = glm::vec3((origin.x - m_originX) / m_horizontalScale, origin.y,
+                          (origin.z - m_originZ) / m_horizontalScale);
+        ray.d = glm::vec3(dir.x / m_horizontalScale, dir.y, dir.z / m_horizontalScale);
+        for (int i = 0; i < 3; i++)
+            ray.invD[i] = std::fabs(ray.d[i]) > 1e-12f ? 1.0f / ray.d[i] : (ray.d[i] >= 0.0f ? 1e30f : -1e30f);
+        ray.tMax = maxT;
+        int sx = ray.d.x >= 0.0f ? 0 : 1;
+        int sz = ray.d.z >= 0.0f ? 0 : 1;
+
+        // 显式栈：每层最多压入 4 个子节点
+        struct Item { int level, nx, nz; };
+        Item stack[4 * 32];
+        int top = 0;
+        stack[top++] = { m_topLevel, 0, 0 };
+
+        while (top > 0) {
+            Item node = stack[--top];
+            int size = 1 << node.level;
+            int x0 = node.nx * size, z0 = node.nz * size;
+            if (x0 >= m_cellsX || z0 >= m_cellsZ) continue;
+            int x1 = std::min(x0 + size, m_cellsX);
+            int z1 = std::min(z0 + size, m_cellsZ);
+
+            if (node.level == 0) {
+                float t;
+                if (IntersectCell(ray, x0, z0, t)) {
+                    if (hitT) *hitT = t;
+                    hitPoint = origin + dir * t;
+                    return true;
+                }
+                continue;
+            }
+
+            const glm::vec2& range = m_levels[node.level][node.nz * m_levelWidth[node.level] + node.nx];
+            float tNear, tFar;
+            if (!IntersectBox(ray, glm::vec3(x0, range.x, z0), glm::vec3(x1, range.y, z1), tNear, tFar))
+                continue;
+
+            // 由远到近压栈，使最近的子节点先出栈；中间两个子节点射线最多穿过其一，顺序无关
+            int cx = node.nx * 2, cz = node.nz * 2;
+            int lv = node.level - 1;
+            stack[top++] = { lv, cx + (1 - sx), cz + (1 - sz) };
+            stack[top++] = { lv, cx + sx, cz + (1 - sz) };
+            stack[top++] = { lv, cx + (1 - sx), cz + sz };
+            stack[top++] = { lv, cx + sx, cz + sz };
+        }
+        return false;
+    }
+
+    int GetLevelCount() const { return m_topLevel + 1; }
+
+    // 金字塔节点的只读访问（遮挡剔除等只需要粗略高度范围的场合），level >= 1
+    int GetLevelWidth(int level) const { return m_levelWidth[level]; }
+    int GetLevelHeight(int level) const { return static_cast<int>(m_levels[level].size()) / m_levelWidth[level]; }
+    // 节点的 (最低, 最高) 世界高度
+    glm::vec2 GetNodeRange(int level, int nx, int nz) const
+    {
+        return m_levels[level][static_cast<size_t>(nz) * m_levelWidth[level] + nx];
+    }
+    // 节点的世界 xz 范围 (minX, minZ, maxX, maxZ)
+    glm::vec4 GetNodeRect(int level, int nx, int nz) const
+    {
+        int size = 1 << level;
+        float x0 = static_cast<float>(nx * size), z0 = static_cast<float>(nz * size);
+        float x1 = static_cast<float>(std::min((nx + 1) * size, m_cellsX));
+        float z1 = static_cast<float>(std::min((nz + 1) * size, m_cellsZ));
+        return glm::vec4(m_originX + x0 * m_horizontalScale, m_originZ + z0 * m_horizontalScale,
+                         m_originX + x1 * m_horizontalScale, m_originZ + z1 * m_horizontalScale);
+    }
+
+    // 高度场中 [x0, x1] x [z0, z1]（闭区间）内的样本被修改后，逐层只重算覆盖这些样本的节点
+    void UpdateRegion(int x0, int z0, int x1, int z1)
+    {
+        // 样本 x 是格子 x-1 和 x 的角点
+        int cx0 = std::max(x0 - 1, 0), cz0 = std::max(z0 - 1, 0);
+        int cx1 = std::min(x1, m_cellsX - 1), cz1 = std::min(z1, m_cellsZ - 1);
+        if (cx0 > cx1 || cz0 > cz1) return;
+
+        for (int level = 1; level <= m_topLevel; level++) {
+            int w = m_levelWidth[level];
+            for (int nz = cz0 >> level; nz <= (cz1 >> level); nz++)
+                for (int nx = cx0 >> level; nx <= (cx1 >> level); nx++)
+                    m_levels[level][static_cast<size_t>(nz) * w + nx] = ComputeRange(level, nx, nz);
+        }
+    }
+
+private:
+    struct Ray
+    {
+        glm::vec3 o, d, invD;
+        float tMax;
+    };
+
+    const std::vector<float>& m_heights;
+    int m_width, m_height;
+    float m_heightScale, m_horizontalScale;
+    float m_originX, m_originZ;
+    int m_cellsX, m_cellsZ;
+    int m_topLevel = 0;
+    std::vector<std::vector<glm::vec2>> m_levels;   // 第 L 层的 (最低, 最高)，第 0 层留空
+    std::vector<int> m_levelWidth;
+
+    float Height(int x, int z) const
+    {
+        x = std::min(x, m_width - 1);
+        z = std::min(z, m_height - 1);
+        return m_heights[static_cast<size_t>(z) * m_width + x] * m_heightScale;
+    }
+
+    void BuildPyramid()
+    {
+        m_topLevel = 0;
+        while ((1 << m_topLevel) < std::max(m_cellsX, m_cellsZ))
+            m_topLevel++;
+
+        m_levels.resize(m_topLevel + 1);
+        m_levelWidth.resize(m_topLevel + 1);
+        m_levelWidth[0] = m_cellsX;
+
+        for (int level = 1; level <= m_topLevel; level++) {
+            int size = 1 << level;
+            int w = (m_cellsX + size - 1) / size;
+            int h = (m_cellsZ + size - 1) / size;
+            m_levelWidth[level] = w;
+            std::vector<glm::vec2>& dst = m_levels[level];
+            dst.resize(static_cast<size_t>(w) * h);
+
+            ParallelFor(h, [&](int nz) {
+                for (int nx = 0; nx < w; nx++)
+                    dst[static_cast<size_t>(nz) * w + nx] = ComputeRange(level, nx, nz);
+            }, 64);
+        }
+    }
+
+    // 第 level 层节点 (nx, nz) 的高度范围：第 1 层直接取 2x2 个格子的 3x3 个角点，更高层合并下一层
+    glm::vec2 ComputeRange(int level, int nx, int nz) const
+    {
+        glm::vec2 range(1e30f, -1e30f);
+        if (level == 1) {
+            for (int z = nz * 2; z <= std::min(nz * 2 + 2, m_cellsZ); z++) {
+                for (int x = nx * 2; x <= std::min(nx * 2 + 2, m_cellsX); x++) {
+                    float v = Height(x, z);
+                    range.x = std::min(range.x, v);
+                    range.y = std::max(range.y, v);
+                }
+            }
+        } else {
+            const std::vector<glm::vec2>& src = m_levels[level - 1];
+            int sw = m_levelWidth[level - 1];
+            int sh = static_cast<int>(src.size()) / sw;
+            for (int z = nz * 2; z < std::min(nz * 2 + 2, sh); z++) {
+                for (int x = nx * 2; x < std::min(nx * 2 + 2, sw); x++) {
+                    range.x = std::min(range.x, src[z * sw + x].x);
+                    range.y = std::max(range.y, src[z * sw + x].y);
+                }
+            }
+        }
+        return range;
+    }
+
+    // 射线与包围盒的 slab 测试，结果裁剪到 [0, tMax]
+    static bool IntersectBox(const Ray& ray, const glm::vec3& bmin, const glm::vec3& bmax,
+                             float& tNear, float& tFar)
+    {
+        glm::vec3 t0 = (bmin - ray.o) * ray.invD;
+        glm::vec3 t1 = (bmax - ray.o) * ray.invD;
+        glm::vec3 tLo = glm::min(t0, t1);
+        glm::vec3 tHi = glm::max(t0, t1);
+        tNear = std::max(std::max(tLo.x, tLo.y), std::max(tLo.z, 0.0f));
+        tFar = std::min(std::min(tHi.x, tHi.y), std::min(tHi.z, ray.tMax));
+        return tNear <= tFar;
+    }
+
+    // 射线与格子 (ix, iz) 上双线性曲面的最近交点
+    bool IntersectCell(const Ray& ray, int ix, int iz, float& tHit) const
+    {
+        float h00 = Height(ix, iz), h10 = Height(ix + 1, iz);
+        float h01 = Height(ix, iz + 1), h11 = Height(ix + 1, iz + 1);
+        float tNear, tFar;
+        glm::vec3 bmin(ix, std::min(std::min(h00, h10), std::min(h01, h11)), iz);
+        glm::vec3 bmax(ix + 1, std::max(std::max(h00, h10), std::max(h01, h11)), iz + 1);
+        if (!IntersectBox(ray, bmin, bmax, tNear, tFar))
+            return false;
+
+        // 以进入点为起点 s = t - tNear，格内坐标 u = u0 + a*s, v = v0 + b*s, y = y0 + c*s
+        // h(u,v) - y = A s^2 + B s + C
+        double u0 = ray.o.x + ray.d.x * tNear - ix;
+        double v0 = ray.o.z + ray.d.z * tNear - iz;
+        double y0 = ray.o.y + ray.d.y * tNear;
+        double a = ray.d.x, b = ray.d.z, c = ray.d.y;
+        double du = h10 - h00, dv = h01 - h00, k = h00 - h10 - h01 + h11;
+
+        double A = k * a * b;
+        double B = du * a + dv * b + k * (u0 * b + v0 * a) - c;
+        double C = h00 + du * u0 + dv * v0 + k * u0 * v0 - y0;
+        double sMax = tFar - tNear;
+        const double eps = 1e-6;
+
+        double roots[2];
+        int count = 0;
+        if (std::fabs(A) < 1e-12) {
+            if (std::fabs(B) > 1e-12) roots[count++] = -C / B;
+        } else {
+            double disc = B * B - 4.0 * A * C;
+            if (disc < 0.0) return false;
+            double q = -0.5 * (B + (B >= 0.0 ? 1.0 : -1.0) * std::sqrt(disc));
+            roots[count++] = q / A;
+            if (std::fabs(q) > 1e-12) roots[count++] = C / q;
+        }
+
+        double best = 1e30;
+        for (int i = 0; i < count; i++) {
+            if (roots[i] >= -eps && roots[i] <= sMax + eps)
+                best = std::min(best, roots[i]);
+        }
+        if (best > sMax + eps) return false;
+        tHit = tNear + static_cast<float>(std::max(best, 0.0));
+        return true;
+    }
+};
+
+#endif // HEIGHTFIELD_RAYCAST_H
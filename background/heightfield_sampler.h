@@ -0,0 +1,244 @@
+#ifndef HEIGHTFIELD_SAMPLER_H
+#define HEIGHTFIELD_SAMPLER_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <parallel.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define HEIGHTFIELD_AVX2 1
+#endif
+
+// 高度场批量查询：双线性插值的高度、法线和坡度
+//
+// 高度按 TILE x TILE 个格子切块重排（每块多存一行一列共享边），任意一个格子的
+// 四个角都落在同一块的相邻两行里，成批查询附近的位置时缓存命中率高；
+// 编译时开启 AVX2 时一次处理 8 个位置，四个角用 gather 读取。
+//
+// 坐标约定与 Terrain 相同：顶点 (x, z) 位于 ((x - width/2) * horizontalScale, (z - height/2) * horizontalScale)。
+// 超出高度图的位置取最近边缘的高度（而不是 0），法线在边缘处退化为单侧差分。
+class HeightfieldSampler
+{
+public:
+    static const int TILE = 16;                      // 每块覆盖的格子数
+    static const int TILE_STRIDE = TILE + 1;         // 每块一行的样本数（含共享边）
+    static const int TILE_SIZE = TILE_STRIDE * TILE_STRIDE;
+    static_assert(TILE == 16, "AVX2 路径按 TILE = 16 做移位");
+
+    HeightfieldSampler(const std::vector<float>& heights, int width, int height,
+                       float heightScale, float horizontalScale)
+        : m_width(width), m_height(height), m_heightScale(heightScale), m_horizontalScale(horizontalScale)
+    {
+        m_originX = -width / 2.0f * horizontalScale;
+        m_originZ = -height / 2.0f * horizontalScale;
+        m_invScale = 1.0f / horizontalScale;
+        m_maxX = static_cast<float>(std::max(width - 1, 0));
+        m_maxZ = static_cast<float>(std::max(height - 1, 0));
+        m_maxCellX = std::max(width - 2, 0);
+        m_maxCellZ = std::max(height - 2, 0);
+        m_tilesX = std::max(1, (width - 1 + TILE - 1) / TILE);
+        m_tilesZ = std::max(1, (height - 1 + TILE - 1) / TILE);
+
+        // 重排时顺便乘上 heightScale，查询结果直接是世界高度
+        m_tiles.resize(static_cast<size_t>(m_tilesX) * m_tilesZ * TILE_SIZE);
+        ParallelFor(m_tilesZ, [&](int tz) {
+            for (int tx = 0; tx < m_tilesX; tx++)
+                FillTile(heights, tx, tz);
+        });
+    }
+
+    // 高度场中 [x0, x1] x [z0, z1]（闭区间）内的样本被修改后，只重排包含这些样本的块
+    void UpdateRegion(const std::vector<float>& heights, int x0, int z0, int x1, int z1)
+    {
+        // 样本 x 属于块 x/TILE，在块边界上还属于左侧块的共享边
+        int tx0 = std::max(0, (std::max(x0, 0) - 1) / TILE);
+        int tz0 = std::max(0, (std::max(z0, 0) - 1) / TILE);
+        int tx1 = std::min(m_tilesX - 1, std::max(x1, 0) / TILE);
+        int tz1 = std::min(m_tilesZ - 1, std::max(z1, 0) / TILE);
+        for (int tz = tz0; tz <= tz1; tz++)
+            for (int tx = tx0; tx <= tx1; tx++)
+                FillTile(heights, tx, tz);
+    }
+
+    // 位置是否落在高度图范围内
+    bool Contains(float x, float z) const
+    {
+        float gx = (x - m_originX) * m_invScale;
+        float gz = (z - m_originZ) * m_invScale;
+        return gx >= 0.0f && gx <= m_maxX && gz >= 0.0f && gz <= m_maxZ;
+    }
+
+    float GetHeight(float x, float z) const
+    {
+        return BilinearGrid((x - m_originX) * m_invScale, (z - m_originZ) * m_invScale);
+    }
+
+    glm::vec3 GetNormal(float x, float z) const
+    {
+        float gx = (x - m_originX) * m_invScale;
+        float gz = (z - m_originZ) * m_invScale;
+        return NormalFromHeights(BilinearGrid(gx - 1.0f, gz), BilinearGrid(gx + 1.0f, gz),
+                                 BilinearGrid(gx, gz - 1.0f), BilinearGrid(gx, gz + 1.0f));
+    }
+
+    // 坡度角（弧度），0 为水平
+    float GetSlope(float x, float z) const
+    {
+        return std::acos(glm::clamp(GetNormal(x, z).y, -1.0f, 1.0f));
+    }
+
+    // 批量高度：xs/zs/heights 为长度 count 的数组
+    void SampleHeights(const float* xs, const float* zs, float* heights, size_t count) const
+    {
+        float gx[BATCH], gz[BATCH];
+        for (size_t start = 0; start < count; start += BATCH) {
+            size_t n = std::min(count - start, static_cast<size_t>(BATCH));
+            ToGrid(xs + start, zs + start, gx, gz, n);
+            BilinearBatch(gx, gz, heights + start, n);
+        }
+    }
+
+    // 批量高度 + 法线 + 坡度角；normals / slopes 可以为空
+    // 法线取 ±1 格处双线性高度的中心差分，等价于把逐顶点的差分法线做双线性插值，跨格连续
+    void Sample(const float* xs, const float* zs, size_t count,
+                float* heights, glm::vec3* normals = nullptr, float* slopes = nullptr) const
+    {
+        float gx[BATCH], gz[BATCH], sx[BATCH], sz[BATCH];
+        float hL[BATCH], hR[BATCH], hD[BATCH], hU[BATCH];
+        for (size_t start = 0; start < count; start += BATCH) {
+            size_t n = std::min(count - start, static_cast<size_t>(BATCH));
+            ToGrid(xs + start, zs + start, gx, gz, n);
+            if (heights)
+                BilinearBatch(gx, gz, heights + start, n);
+            if (!normals && !slopes) continue;
+
+            for (size_t i = 0; i < n; i++) sx[i] = gx[i] - 1.0f;
+            BilinearBatch(sx, gz, hL, n);
+            for (size_t i = 0; i < n; i++) sx[i] = gx[i] + 1.0f;
+            BilinearBatch(sx, gz, hR, n);
+            for (size_t i = 0; i < n; i++) sz[i] = gz[i] - 1.0f;
+            BilinearBatch(gx, sz, hD, n);
+            for (size_t i = 0; i < n; i++) sz[i] = gz[i] + 1.0f;
+            BilinearBatch(gx, sz, hU, n);
+
+            for (size_t i = 0; i < n; i++) {
+                glm::vec3 normal = NormalFromHeights(hL[i], hR[i], hD[i], hU[i]);
+                if (normals) normals[start + i] = normal;
+                if (slopes) slopes[start + i] = std::acos(glm::clamp(normal.y, -1.0f, 1.0f));
+            }
+        }
+    }
+
+    int GetWidth() const { return m_width; }
+    int GetLength() const { return m_height; }
+
+private:
+    static const int BATCH = 256;   // 分批处理，临时数组放在栈上
+
+    int m_width, m_height;
+    float m_heightScale, m_horizontalScale;
+    float m_originX, m_originZ, m_invScale;
+    float m_maxX, m_maxZ;
+    int m_maxCellX, m_maxCellZ;
+    int m_tilesX, m_tilesZ;
+    std::vector<float> m_tiles;
+
+    void FillTile(const std::vector<float>& heights, int tx, int tz)
+    {
+        float* tile = &m_tiles[(static_cast<size_t>(tz) * m_tilesX + tx) * TILE_SIZE];
+        for (int lz = 0; lz < TILE_STRIDE; lz++) {
+            int z = std::min(tz * TILE + lz, m_height - 1);
+            for (int lx = 0; lx < TILE_STRIDE; lx++) {
+                int x = std::min(tx * TILE + lx, m_width - 1);
+                tile[lz * TILE_STRIDE + lx] = heights[static_cast<size_t>(z) * m_width + x] * m_heightScale;
+            }
+        }
+    }
+
+    glm::vec3 NormalFromHeights(float hL, float hR, float hD, float hU) const
+    {
+        float inv = 1.0f / (2.0f * m_horizontalScale);
+        return glm::normalize(glm::vec3((hL - hR) * inv, 1.0f, (hD - hU) * inv));
+    }
+
+    void ToGrid(const float* xs, const float* zs, float* gx, float* gz, size_t n) const
+    {
+        for (size_t i = 0; i < n; i++) {
+            gx[i] = (xs[i] - m_originX) * m_invScale;
+            gz[i] = (zs[i] - m_originZ) * m_invScale;
+        }
+    }
+
+    // 格子 (ix, iz) 左上角样本在重排数组中的下标
+    size_t Offset(int ix, int iz) const
+    {
+        return (static_cast<size_t>(iz / TILE) * m_tilesX + ix / TILE) * TILE_SIZE
+             + (iz % TILE) * TILE_STRIDE + ix % TILE;
+    }
+
+    float BilinearGrid(float gx, float gz) const
+    {
+        gx = glm::clamp(gx, 0.0f, m_maxX);
+        gz = glm::clamp(gz, 0.0f, m_maxZ);
+        int ix = std::min(static_cast<int>(gx), m_maxCellX);
+        int iz = std::min(static_cast<int>(gz), m_maxCellZ);
+        float fx = gx - ix;
+        float fz = gz - iz;
+
+        const float* p = &m_tiles[Offset(ix, iz)];
+        float h0 = p[0] + (p[1] - p[0]) * fx;
+        float h1 = p[TILE_STRIDE] + (p[TILE_STRIDE + 1] - p[TILE_STRIDE]) * fx;
+        return h0 + (h1 - h0) * fz;
+    }
+
+    void BilinearBatch(const float* gx, const float* gz, float* out, size_t n) const
+    {
+        size_t i = 0;
+#ifdef HEIGHTFIELD_AVX2
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 maxX = _mm256_set1_ps(m_maxX);
+        const __m256 maxZ = _mm256_set1_ps(m_maxZ);
+        const __m256i maxCellX = _mm256_set1_epi32(m_maxCellX);
+        const __m256i maxCellZ = _mm256_set1_epi32(m_maxCellZ);
+        const __m256i tilesX = _mm256_set1_epi32(m_tilesX);
+        const __m256i tileSize = _mm256_set1_epi32(TILE_SIZE);
+        const __m256i tileStride = _mm256_set1_epi32(TILE_STRIDE);
+        const __m256i tileMask = _mm256_set1_epi32(TILE - 1);
+        const __m256i one = _mm256_set1_epi32(1);
+        const float* base = m_tiles.data();
+
+        for (; i + 8 <= n; i += 8) {
+            __m256 x = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(gx + i), zero), maxX);
+            __m256 z = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(gz + i), zero), maxZ);
+            __m256i ix = _mm256_min_epi32(_mm256_cvttps_epi32(x), maxCellX);
+            __m256i iz = _mm256_min_epi32(_mm256_cvttps_epi32(z), maxCellZ);
+            __m256 fx = _mm256_sub_ps(x, _mm256_cvtepi32_ps(ix));
+            __m256 fz = _mm256_sub_ps(z, _mm256_cvtepi32_ps(iz));
+
+            // TILE 为 2 的幂：除法和取模换成移位与掩码
+            __m256i tile = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(iz, 4), tilesX),
+                                            _mm256_srli_epi32(ix, 4));
+            __m256i idx = _mm256_add_epi32(_mm256_mullo_epi32(tile, tileSize),
+                          _mm256_add_epi32(_mm256_mullo_epi32(_mm256_and_si256(iz, tileMask), tileStride),
+                                           _mm256_and_si256(ix, tileMask)));
+            __m256i idxDown = _mm256_add_epi32(idx, tileStride);
+
+            __m256 p00 = _mm256_i32gather_ps(base, idx, 4);
+            __m256 p10 = _mm256_i32gather_ps(base, _mm256_add_epi32(idx, one), 4);
+            __m256 p01 = _mm256_i32gather_ps(base, idxDown, 4);
+            __m256 p11 = _mm256_i32gather_ps(base, _mm256_add_epi32(idxDown, one), 4);
+
+            __m256 h0 = _mm256_add_ps(p00, _mm256_mul_ps(_mm256_sub_ps(p10, p00), fx));
+            __m256 h1 = _mm256_add_ps(p01, _mm256_mul_ps(_mm256_sub_ps(p11, p01), fx));
+            _mm256_storeu_ps(out + i, _mm256_add_ps(h0, _mm256_mul_ps(_mm256_sub_ps(h1, h0), fz)));
+        }
+#endif
+        for (; i < n; i++)
+            out[i] = BilinearGrid(gx[i], gz[i]);
+    }
+};
+
+#endif // HEIGHTFIELD_SAMPLER_H
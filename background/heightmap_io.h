@@ -0,0 +1,313 @@
+#ifndef HEIGHTMAP_IO_H
+#define HEIGHTMAP_IO_H
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#endif
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+#include <iostream>
+#include <mapped_file.h>
+#include <parallel.h>
+
+// 高度图读取：统一按行提供 [0,1] 的归一化高度
+//
+// 支持的格式：
+//   .png/.jpg 等  8 位或 16 位灰度图，用 stb_image 解码（16 位 PNG 不再被截成 256 级）
+//   .r16          无文件头的小端 uint16 方阵，65535 对应 1.0
+//   .r32          无文件头的 float32 方阵，值直接作为归一化高度
+//   .hft          分块二进制高度场（见 TiledHeightfieldHeader），可由 WriteTiled 生成
+// 后三种用内存映射直接读取，不复制整张图；图片格式只能先整张解码，超大地图建议先转成 .hft。
+//
+// Downsample 按输出行并行，每个线程只流式读取自己需要的源行做盒式平均，
+// 全分辨率数据不会整张展开成 float。
+
+// .hft 文件头，之后按行优先存放所有 tile，每个 tile 固定 tileSize^2 个样本（边缘 tile 补齐）
+struct TiledHeightfieldHeader
+{
+    char magic[4];          // "HFT1"
+    uint32_t width;
+    uint32_t height;
+    uint32_t tileSize;
+    uint32_t sampleBytes;   // 2 = uint16 (65535 对应 1.0)，4 = float
+    uint32_t reserved[3];
+};
+
+class HeightmapFile
+{
+public:
+    enum class Format { Image8, Image16, Raw16, Raw32, Tiled };
+
+    HeightmapFile() {}
+    ~HeightmapFile() { Close(); }
+
+    HeightmapFile(const HeightmapFile&) = delete;
+    HeightmapFile& operator=(const HeightmapFile&) = delete;
+
+    bool Open(const std::string& path)
+    {
+        Close();
+        std::string ext = Extension(path);
+        if (ext == ".r16" || ext == ".r32")
+            return OpenRaw(path, ext == ".r16" ? 2 : 4);
+        if (ext == ".hft")
+            return OpenTiled(path);
+        return OpenImage(path);
+    }
+
+    void Close()
+    {
+        if (m_pixels) stbi_image_free(m_pixels);
+        m_pixels = nullptr;
+        m_file.Close();
+        m_samples = nullptr;
+        m_width = m_height = 0;
+    }
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    Format GetFormat() const { return m_format; }
+
+    const char* GetFormatName() const
+    {
+        switch (m_format) {
+        case Format::Image8:  return "8-bit image";
+        case Format::Image16: return "16-bit image";
+        case Format::Raw16:   return "raw 16-bit, mapped";
+        case Format::Raw32:   return "raw float, mapped";
+        default:              return "tiled, mapped";
+        }
+    }
+
+    // 读取第 z 行的 width 个归一化高度
+    void ReadRow(int z, float* out) const
+    {
+        ReadRowSpan(z, 0, m_width, out);
+    }
+
+    // 读取第 z 行从 x0 开始的 count 个归一化高度（分页加载只读需要的一段）
+    void ReadRowSpan(int z, int x0, int count, float* out) const
+    {
+        size_t start = static_cast<size_t>(z) * m_width + x0;
+        switch (m_format) {
+        case Format::Image8:
+        {
+            const unsigned char* row = static_cast<const unsigned char*>(m_samples) + start;
+            for (int x = 0; x < count; x++) out[x] = row[x] / 255.0f;
+            break;
+        }
+        case Format::Image16:
+        case Format::Raw16:
+            ConvertRow(static_cast<const uint16_t*>(m_samples) + start, out, count);
+            break;
+        case Format::Raw32:
+            std::memcpy(out, static_cast<const float*>(m_samples) + start, count * sizeof(float));
+            break;
+        case Format::Tiled:
+            ReadTiledRow(z, x0, count, out);
+            break;
+        }
+    }
+
+    // lod x lod 盒式平均降采样，lod = 1 时为原分辨率
+    void Downsample(int lod, std::vector<float>& out, int& outWidth, int& outHeight) const
+    {
+        lod = std::max(1, lod);
+        outWidth = std::max(1, m_width / lod);
+        outHeight = std::max(1, m_height / lod);
+        out.resize(static_cast<size_t>(outWidth) * outHeight);
+
+        int srcWidth = m_width, srcHeight = m_height;
+        int dstWidth = outWidth;
+        ParallelForRange(outHeight, [&](int begin, int end) {
+            std::vector<float> row(srcWidth);
+            for (int z = begin; z < end; z++) {
+                float* dst = &out[static_cast<size_t>(z) * dstWidth];
+                if (lod == 1) {
+                    ReadRow(z, dst);
+                    continue;
+                }
+
+                std::fill(dst, dst + dstWidth, 0.0f);
+                int rows = 0;
+                for (int k = 0; k < lod && z * lod + k < srcHeight; k++, rows++) {
+                    ReadRow(z * lod + k, row.data());
+                    for (int x = 0; x < dstWidth; x++) {
+                        float sum = 0.0f;
+                        if ((x + 1) * lod <= srcWidth) {
+                            const float* src = &row[static_cast<size_t>(x) * lod];
+                            for (int j = 0; j < lod; j++) sum += src[j];
+                        } else {
+                            // 源图比 lod 还窄时（outWidth 被限制为 1）重复最后一列，不读出行尾
+                            for (int j = 0; j < lod; j++) sum += row[std::min(x * lod + j, srcWidth - 1)];
+                        }
+                        dst[x] += sum;
+                    }
+                }
+                float inv = 1.0f / (static_cast<float>(rows) * lod);
+                for (int x = 0; x < dstWidth; x++) dst[x] *= inv;
+            }
+        }, 4);
+    }
+
+    // 把归一化高度写成 .hft；sampleBytes = 2 时量化为 uint16
+    static bool WriteTiled(const std::string& path, const float* data, int width, int height,
+                           int tileSize = 256, int sampleBytes = 2)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) return false;
+
+        TiledHeightfieldHeader header = {};
+        std::memcpy(header.magic, "HFT1", 4);
+        header.width = width;
+        header.height = height;
+        header.tileSize = tileSize;
+        header.sampleBytes = sampleBytes;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        int tilesX = (width + tileSize - 1) / tileSize;
+        int tilesZ = (height + tileSize - 1) / tileSize;
+        std::vector<float> tile(static_cast<size_t>(tileSize) * tileSize);
+        std::vector<uint16_t> packed(tile.size());
+        for (int tz = 0; tz < tilesZ; tz++) {
+            for (int tx = 0; tx < tilesX; tx++) {
+                // 边缘 tile 用最后一行/列补齐
+                for (int lz = 0; lz < tileSize; lz++) {
+                    int z = std::min(tz * tileSize + lz, height - 1);
+                    for (int lx = 0; lx < tileSize; lx++) {
+                        int x = std::min(tx * tileSize + lx, width - 1);
+                        tile[static_cast<size_t>(lz) * tileSize + lx] = data[static_cast<size_t>(z) * width + x];
+                    }
+                }
+                if (sampleBytes == 2) {
+                    for (size_t i = 0; i < tile.size(); i++)
+                        packed[i] = static_cast<uint16_t>(std::lround(std::min(std::max(tile[i], 0.0f), 1.0f) * 65535.0f));
+                    file.write(reinterpret_cast<const char*>(packed.data()), packed.size() * sizeof(uint16_t));
+                } else {
+                    file.write(reinterpret_cast<const char*>(tile.data()), tile.size() * sizeof(float));
+                }
+            }
+        }
+        return static_cast<bool>(file);
+    }
+
+private:
+    Format m_format = Format::Image8;
+    int m_width = 0, m_height = 0;
+    void* m_pixels = nullptr;           // stb_image 解码结果（图片格式）
+    MappedFile m_file;                  // 映射的文件（raw / tiled 格式）
+    const void* m_samples = nullptr;    // 第一个样本
+    int m_tileSize = 0, m_tilesX = 0, m_sampleBytes = 0;
+
+    static std::string Extension(const std::string& path)
+    {
+        size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos) return "";
+        std::string ext = path.substr(dot);
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return ext;
+    }
+
+    static void ConvertRow(const uint16_t* src, float* out, int count)
+    {
+        const float inv = 1.0f / 65535.0f;
+        for (int i = 0; i < count; i++) out[i] = src[i] * inv;
+    }
+
+    bool OpenImage(const std::string& path)
+    {
+        int channels;
+        if (stbi_is_16_bit(path.c_str())) {
+            m_pixels = stbi_load_16(path.c_str(), &m_width, &m_height, &channels, 1);
+            m_format = Format::Image16;
+        } else {
+            m_pixels = stbi_load(path.c_str(), &m_width, &m_height, &channels, 1);
+            m_format = Format::Image8;
+        }
+        if (!m_pixels) {
+            std::cout << "Error: " << stbi_failure_reason() << std::endl;
+            m_width = m_height = 0;
+            return false;
+        }
+        m_samples = m_pixels;
+        return true;
+    }
+
+    // 无文件头的方阵，边长由文件大小推出
+    bool OpenRaw(const std::string& path, int sampleBytes)
+    {
+        if (!m_file.Open(path)) return false;
+        size_t count = m_file.Size() / sampleBytes;
+        int side = static_cast<int>(std::lround(std::sqrt(static_cast<double>(count))));
+        if (static_cast<size_t>(side) * side != count || count * sampleBytes != m_file.Size()) {
+            std::cout << "Raw heightmap is not a square of " << sampleBytes << "-byte samples: " << path << std::endl;
+            Close();
+            return false;
+        }
+        m_width = m_height = side;
+        m_samples = m_file.Data();
+        m_format = sampleBytes == 2 ? Format::Raw16 : Format::Raw32;
+        return true;
+    }
+
+    bool OpenTiled(const std::string& path)
+    {
+        if (!m_file.Open(path) || m_file.Size() < sizeof(TiledHeightfieldHeader)) {
+            Close();
+            return false;
+        }
+        TiledHeightfieldHeader header;
+        std::memcpy(&header, m_file.Data(), sizeof(header));
+        bool valid = std::memcmp(header.magic, "HFT1", 4) == 0 && header.tileSize > 0 &&
+                     (header.sampleBytes == 2 || header.sampleBytes == 4);
+        if (valid) {
+            size_t tilesX = (header.width + header.tileSize - 1) / header.tileSize;
+            size_t tilesZ = (header.height + header.tileSize - 1) / header.tileSize;
+            size_t expected = sizeof(header) + tilesX * tilesZ * header.tileSize * header.tileSize * header.sampleBytes;
+            valid = m_file.Size() >= expected;
+        }
+        if (!valid) {
+            std::cout << "Invalid tiled heightfield: " << path << std::endl;
+            Close();
+            return false;
+        }
+
+        m_width = header.width;
+        m_height = header.height;
+        m_tileSize = header.tileSize;
+        m_tilesX = (m_width + m_tileSize - 1) / m_tileSize;
+        m_sampleBytes = header.sampleBytes;
+        m_samples = m_file.Data() + sizeof(header);
+        m_format = Format::Tiled;
+        return true;
+    }
+
+    // 一行横跨多个 tile，每个 tile 里取连续的一段
+    void ReadTiledRow(int z, int x0, int count, float* out) const
+    {
+        int tz = z / m_tileSize, lz = z % m_tileSize;
+        size_t tileSamples = static_cast<size_t>(m_tileSize) * m_tileSize;
+        int x = x0, end = x0 + count;
+        while (x < end) {
+            int tx = x / m_tileSize, lx = x % m_tileSize;
+            int n = std::min(m_tileSize - lx, end - x);
+            size_t offset = (static_cast<size_t>(tz) * m_tilesX + tx) * tileSamples
+                          + static_cast<size_t>(lz) * m_tileSize + lx;
+            if (m_sampleBytes == 2)
+                ConvertRow(static_cast<const uint16_t*>(m_samples) + offset, out + (x - x0), n);
+            else
+                std::memcpy(out + (x - x0), static_cast<const float*>(m_samples) + offset, n * sizeof(float));
+            x += n;
+        }
+    }
+};
+
+#endif // HEIGHTMAP_IO_H
@@ -0,0 +1,39 @@
+#version 330 core
+out float MinDepth;
+
+uniform sampler2D uSource;
+uniform int uCopyDepth;     // 1 表示直接从屏幕深度纹理拷贝第 0 级
+uniform ivec2 uSourceSize;  // 上一级的尺寸
+
+// 上一级已设为 BASE_LEVEL，texelFetch 的 lod 相对于 BASE_LEVEL，所以总是取 0
+
+float Fetch(ivec2 p)
+{
+    return texelFetch(uSource, min(p, uSourceSize - 1), 0).r;
+}
+
+void main()
+{
+    ivec2 dst = ivec2(gl_FragCoord.xy);
+    if (uCopyDepth == 1)
+    {
+        MinDepth = texelFetch(uSource, dst, 0).r;
+        return;
+    }
+
+    ivec2 src = dst * 2;
+    float d = min(min(Fetch(src), Fetch(src + ivec2(1, 0))),
+                  min(Fetch(src + ivec2(0, 1)), Fetch(src + ivec2(1, 1))));
+
+    // 上一级尺寸为奇数时，最后一行/列还要多覆盖一个纹素，保证结果保守
+    bool extraX = (uSourceSize.x & 1) == 1 && src.x + 2 == uSourceSize.x - 1;
+    bool extraY = (uSourceSize.y & 1) == 1 && src.y + 2 == uSourceSize.y - 1;
+    if (extraX)
+        d = min(d, min(Fetch(src + ivec2(2, 0)), Fetch(src + ivec2(2, 1))));
+    if (extraY)
+        d = min(d, min(Fetch(src + ivec2(0, 2)), Fetch(src + ivec2(1, 2))));
+    if (extraX && extraY)
+        d = min(d, Fetch(src + ivec2(2, 2)));
+
+    MinDepth = d;
+}
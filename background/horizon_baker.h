@@ -0,0 +1,189 @@
+#ifndef HORIZON_BAKER_H
+#define HORIZON_BAKER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <parallel.h>
+
+// 地形地平线图：加载时对 8 个方位（沿网格的行、列和对角线）算出每个点的地平线仰角，
+// 着色器据此得到任意太阳方向的可见度（地形自阴影）和环境光遮蔽，地形不必再画进阴影贴图。
+//
+// 每个方位沿步长 k 比较 h[p + k*d] 与 h[p]，近处每个样本都比较，远处步长逐渐加大，最远 MAX_REACH 个样本。
+// 方向都落在网格上，所以按整行扫描：固定 k 时源样本就是另一行平移 k 列，
+// 内层循环是两段连续内存上的逐元素 max，可以被编译器向量化；行之间按多线程切分。
+//
+// 高度图大于 maxResolution 时先盒式降采样（地平线和 AO 都是低频量）。
+// 结果存为 2 层 RGBA8 纹理数组，第 i 个方位（方位角 i * 45°，从 +X 转向 +Z）
+// 在第 i / 4 层的第 i % 4 个通道，值为 仰角 / (π/2)，低于水平的记为 0。
+class HorizonBaker
+{
+public:
+    static const int DIRECTIONS = 8;
+    static const int MAX_REACH = 128;   // 以地平线图的样本计
+
+    // heights 需要在本对象存活期间保持有效（局部更新时重新读取）
+    HorizonBaker(const std::vector<float>& heights, int width, int height,
+                 float heightScale, float horizontalScale, int maxResolution = 1024)
+        : m_source(heights), m_srcWidth(width), m_srcHeight(height),
+          m_heightScale(heightScale), m_horizontalScale(horizontalScale)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        m_lod = std::max(1, (std::max(width, height) - 1 + maxResolution - 1) / maxResolution);
+        m_width = std::max(1, width / m_lod);
+        m_height = std::max(1, height / m_lod);
+        m_texelSize = horizontalScale * m_lod;
+        m_grid.resize(static_cast<size_t>(m_width) * m_height);
+        m_angles.resize(static_cast<size_t>(m_width) * m_height * DIRECTIONS);
+
+        for (int k = 1; k <= MAX_REACH; k += (k < 16 ? 1 : k < 32 ? 2 : k < 64 ? 4 : 8))
+            m_steps.push_back(k);
+
+        Downsample(0, 0, m_width - 1, m_height - 1);
+        Bake(0, 0, m_width - 1, m_height - 1);
+        Upload();
+
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "Horizon map baked: " << m_width << "x" << m_height << " x " << DIRECTIONS
+                  << " directions in " << std::chrono::duration<float, std::milli>(end - start).count()
+                  << " ms" << std::endl;
+    }
+
+    ~HorizonBaker()
+    {
+        if (texture) glDeleteTextures(1, &texture);
+    }
+
+    // 源高度图中 [x0, x1] x [z0, z1]（闭区间）被修改后，只重算能“看到”这块区域的点并上传
+    void UpdateRegion(int x0, int z0, int x1, int z1)
+    {
+        int gx0 = std::max(x0 / m_lod, 0), gz0 = std::max(z0 / m_lod, 0);
+        int gx1 = std::min(x1 / m_lod, m_width - 1), gz1 = std::min(z1 / m_lod, m_height - 1);
+        if (gx0 > gx1 || gz0 > gz1) return;
+        Downsample(gx0, gz0, gx1, gz1);
+
+        gx0 = std::max(gx0 - MAX_REACH, 0);
+        gz0 = std::max(gz0 - MAX_REACH, 0);
+        gx1 = std::min(gx1 + MAX_REACH, m_width - 1);
+        gz1 = std::min(gz1 + MAX_REACH, m_height - 1);
+        Bake(gx0, gz0, gx1, gz1);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, m_width);
+        for (int layer = 0; layer < 2; layer++) {
+            const uint8_t* src = &m_angles[LayerOffset(layer) + (static_cast<size_t>(gz0) * m_width + gx0) * 4];
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, gx0, gz0, layer, gx1 - gx0 + 1, gz1 - gz0 + 1, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, src);
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+
+    unsigned int GetTexture() const { return texture; }
+
+    // 世界 xz 到纹理坐标：uv = (xz - rect.xy) * rect.zw，坐标约定与 Terrain 相同
+    glm::vec4 GetRect() const
+    {
+        float halfTexel = 0.5f * m_lod;
+        float centerOffset = (m_lod - 1) * 0.5f;
+        return glm::vec4((centerOffset - m_srcWidth / 2.0f - halfTexel) * m_horizontalScale,
+                         (centerOffset - m_srcHeight / 2.0f - halfTexel) * m_horizontalScale,
+                         1.0f / (m_texelSize * m_width), 1.0f / (m_texelSize * m_height));
+    }
+
+private:
+    const std::vector<float>& m_source;
+    int m_srcWidth, m_srcHeight;
+    float m_heightScale, m_horizontalScale;
+    int m_lod;
+    int m_width, m_height;
+    float m_texelSize;
+    std::vector<float> m_grid;       // 降采样后的世界高度
+    std::vector<uint8_t> m_angles;   // 两层 RGBA8，按层连续存放
+    std::vector<int> m_steps;
+    unsigned int texture = 0;
+
+    size_t LayerOffset(int layer) const { return static_cast<size_t>(layer) * m_width * m_height * 4; }
+
+    void Downsample(int gx0, int gz0, int gx1, int gz1)
+    {
+        ParallelForRange(gz1 - gz0 + 1, [&](int begin, int end) {
+            for (int gz = gz0 + begin; gz < gz0 + end; gz++) {
+                for (int gx = gx0; gx <= gx1; gx++) {
+                    float sum = 0.0f;
+                    for (int j = 0; j < m_lod; j++) {
+                        int z = std::min(gz * m_lod + j, m_srcHeight - 1);
+                        for (int i = 0; i < m_lod; i++) {
+                            int x = std::min(gx * m_lod + i, m_srcWidth - 1);
+                            sum += m_source[static_cast<size_t>(z) * m_srcWidth + x];
+                        }
+                    }
+                    m_grid[static_cast<size_t>(gz) * m_width + gx] = sum / (m_lod * m_lod) * m_heightScale;
+                }
+            }
+        }, 16);
+    }
+
+    void Bake(int gx0, int gz0, int gx1, int gz1)
+    {
+        static const int DIR[DIRECTIONS][2] = {
+            { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 }
+        };
+        int count = gx1 - gx0 + 1;
+        const float scale = 255.0f / glm::half_pi<float>();
+
+        ParallelForRange(gz1 - gz0 + 1, [&](int begin, int end) {
+            std::vector<float> best(count);
+            for (int gz = gz0 + begin; gz < gz0 + end; gz++) {
+                const float* row = &m_grid[static_cast<size_t>(gz) * m_width];
+
+                for (int d = 0; d < DIRECTIONS; d++) {
+                    int dx = DIR[d][0], dz = DIR[d][1];
+                    float stepLength = m_texelSize * std::sqrt(static_cast<float>(dx * dx + dz * dz));
+                    std::fill(best.begin(), best.end(), 0.0f);
+
+                    for (int k : m_steps) {
+                        int sz = gz + k * dz;
+                        if (sz < 0 || sz >= m_height) break;
+                        // 源样本 x + k*dx 必须在图内
+                        int xa = std::max(gx0, -k * dx), xb = std::min(gx1, m_width - 1 - k * dx);
+                        if (xa > xb) break;
+                        // 行首指针加列偏移，dx < 0 时也不会构造出数组之外的指针
+                        const float* src = &m_grid[static_cast<size_t>(sz) * m_width];
+                        int offset = k * dx;
+                        float invDistance = 1.0f / (k * stepLength);
+                        float* out = best.data();
+                        for (int x = xa; x <= xb; x++) {
+                            float slope = (src[x + offset] - row[x]) * invDistance;
+                            out[x - gx0] = slope > out[x - gx0] ? slope : out[x - gx0];
+                        }
+                    }
+
+                    uint8_t* dst = &m_angles[LayerOffset(d / 4) + (static_cast<size_t>(gz) * m_width + gx0) * 4 + d % 4];
+                    for (int i = 0; i < count; i++)
+                        dst[i * 4] = static_cast<uint8_t>(std::atan(best[i]) * scale + 0.5f);
+                }
+            }
+        }, 8);
+    }
+
+    void Upload()
+    {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, m_width, m_height, 2, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, m_angles.data());
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+};
+
+#endif // HORIZON_BAKER_H
@@ -0,0 +1,220 @@
+#ifndef OCCLUSION_HORIZON_H
+#define OCCLUSION_HORIZON_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "heightfield_raycast.h"
+
+// 地形遮挡剔除（occlusion horizon）：相机贴近沙滩时，被沙丘挡住的物体不必提交绘制。
+//
+// 以相机为中心把水平方位角分成 BINS 份，每份记录已处理地形在该方位上的最大仰角（存正切），
+// 即一条 1D 地平线。地形取 HeightfieldRayCaster 的 min/max 金字塔节点，近处细、远处粗；
+// 节点最低高度是它覆盖范围内地表的下界，且只写入完全落在节点角度范围内的方位格，所以结果是保守的。
+// 物体与地形节点都按由近到远处理：测试一个物体前，只插入整体比它更近的节点；
+// 物体在它覆盖的每个方位格上的最高仰角都低于地平线时即被完全挡住。
+//
+// 在方位角/仰角空间而不是屏幕列上做，相机俯仰时依然成立：同一竖直平面内的遮挡关系与视线方向无关。
+class OcclusionHorizon
+{
+public:
+    static const int BINS = 1024;
+
+    // 一批世界 AABB 对相机位置 cameraPos 的可见性，visible[i] = 0 表示被地形完全挡住
+    void Cull(const HeightfieldRayCaster& terrain, const glm::vec3& cameraPos,
+              const glm::vec3* boxMin, const glm::vec3* boxMax, size_t count, uint8_t* visible)
+    {
+        m_camera = cameraPos;
+        m_culled = 0;
+        m_occluders.clear();
+        m_objects.clear();
+        std::fill(m_horizon, m_horizon + BINS, -1e30f);
+
+        // 物体：相机在其水平投影内的直接可见，其余按最近距离排序
+        float maxDistance = 0.0f;
+        for (size_t i = 0; i < count; i++) {
+            visible[i] = 1;
+            Entry e;
+            glm::vec4 rect(boxMin[i].x, boxMin[i].z, boxMax[i].x, boxMax[i].z);
+            if (!MeasureDistance(rect, e))
+                continue;
+            MeasureAngles(rect, e);
+            // 最高仰角的上界
+            float dy = boxMax[i].y - m_camera.y;
+            e.tangent = dy > 0.0f ? dy / e.dmin : dy / e.dmax;
+            e.index = i;
+            m_objects.push_back(e);
+            maxDistance = std::max(maxDistance, e.dmin);
+        }
+        if (m_objects.empty()) return;
+
+        std::sort(m_objects.begin(), m_objects.end(),
+                  [](const Entry& a, const Entry& b) { return a.dmin < b.dmin; });
+        m_objectDistance.clear();
+        for (const Entry& object : m_objects)
+            m_objectDistance.push_back(object.dmin);
+
+        // 地形节点按“第一个比它远的物体”分桶（计数排序），不必对所有节点排序
+        CollectOccluders(terrain, maxDistance);
+        m_bucketStart.assign(m_objects.size() + 1, 0);
+        for (const Entry& e : m_occluders)
+            m_bucketStart[e.index + 1]++;
+        for (size_t k = 1; k < m_bucketStart.size(); k++)
+            m_bucketStart[k] += m_bucketStart[k - 1];
+        m_sorted.resize(m_occluders.size());
+        m_bucketFill.assign(m_bucketStart.begin(), m_bucketStart.end() - 1);
+        for (const Entry& e : m_occluders)
+            m_sorted[m_bucketFill[e.index]++] = e;
+
+        for (size_t k = 0; k < m_objects.size(); k++) {
+            for (size_t j = m_bucketStart[k]; j < m_bucketStart[k + 1]; j++)
+                Insert(m_sorted[j]);
+            if (m_bucketStart[k + 1] > 0 && Occluded(m_objects[k])) {
+                visible[m_objects[k].index] = 0;
+                m_culled++;
+            }
+        }
+    }
+
+    int GetOccluderCount() const { return static_cast<int>(m_occluders.size()); }
+    int GetCulledCount() const { return m_culled; }
+
+private:
+    // 地形节点或物体在水平面上的投影矩形相对相机的度量
+    struct Entry
+    {
+        float lo, hi;        // 方位范围（伪角度，可能超出 [0, 4)）
+        float dmin, dmax;    // 水平距离范围
+        float tangent;       // 地形：仰角正切的下界；物体：上界
+        size_t index;        // 物体：在输入中的下标；地形：所属的物体桶
+    };
+
+    // 节点边长超过 距离 * SUBDIVIDE 时继续细分（约 7°）
+    const float SUBDIVIDE = 0.125f;
+
+    struct Node { int level, nx, nz; };
+
+    float m_horizon[BINS];
+    std::vector<Node> m_stack;
+    std::vector<Entry> m_occluders, m_sorted;
+    std::vector<Entry> m_objects;
+    std::vector<float> m_objectDistance;
+    std::vector<size_t> m_bucketStart, m_bucketFill;
+    glm::vec3 m_camera;
+    int m_culled = 0;
+
+    // rect = (minX, minZ, maxX, maxZ)，相机位于矩形内时返回 false
+    bool MeasureDistance(const glm::vec4& rect, Entry& e) const
+    {
+        float cx = m_camera.x, cz = m_camera.z;
+        if (cx >= rect.x && cx <= rect.z && cz >= rect.y && cz <= rect.w)
+            return false;
+
+        float dx = std::max(std::max(rect.x - cx, cx - rect.z), 0.0f);
+        float dz = std::max(std::max(rect.y - cz, cz - rect.w), 0.0f);
+        e.dmin = std::sqrt(dx * dx + dz * dz);
+        float fx = std::max(std::fabs(rect.x - cx), std::fabs(rect.z - cx));
+        float fz = std::max(std::fabs(rect.y - cz), std::fabs(rect.w - cz));
+        e.dmax = std::sqrt(fx * fx + fz * fz);
+        return true;
+    }
+
+    void MeasureAngles(const glm::vec4& rect, Entry& e) const
+    {
+        float cx = m_camera.x, cz = m_camera.z;
+        // 四个角相对中心方向的角度，避免在周期边界处断开
+        float center = PseudoAngle((rect.x + rect.z) * 0.5f - cx, (rect.y + rect.w) * 0.5f - cz);
+        e.lo = 1e30f;
+        e.hi = -1e30f;
+        for (int k = 0; k < 4; k++) {
+            float x = (k & 1) ? rect.z : rect.x;
+            float z = (k & 2) ? rect.w : rect.y;
+            float a = PseudoAngle(x - cx, z - cz) - center;
+            if (a > 2.0f) a -= 4.0f;
+            if (a < -2.0f) a += 4.0f;
+            e.lo = std::min(e.lo, a);
+            e.hi = std::max(e.hi, a);
+        }
+        e.lo += center;
+        e.hi += center;
+    }
+
+    // 与 atan2 单调对应、周期为 4 的伪角度（菱形角），省去三角函数；
+    // 方位格在真实角度上不均匀，但保守性只依赖单调性
+    static float PseudoAngle(float x, float z)
+    {
+        float sum = std::fabs(x) + std::fabs(z);
+        if (sum <= 0.0f) return 0.0f;
+        float p = x / sum;   // [-1, 1]
+        return z >= 0.0f ? 1.0f - p : 3.0f + p;
+    }
+
+    static float BinCoord(float angle) { return angle * (BINS / 4.0f); }
+
+    static int Wrap(int bin) { return ((bin % BINS) + BINS) % BINS; }
+
+    // 自顶向下遍历金字塔：离相机越近节点越细，maxDistance 之外的节点挡不住任何物体
+    void CollectOccluders(const HeightfieldRayCaster& terrain, float maxDistance)
+    {
+        std::vector<Node>& stack = m_stack;
+        stack.clear();
+        int top = terrain.GetLevelCount() - 1;
+        if (top < 1) return;
+        stack.push_back({ top, 0, 0 });
+
+        while (!stack.empty()) {
+            Node node = stack.back();
+            stack.pop_back();
+            if (node.nx >= terrain.GetLevelWidth(node.level) || node.nz >= terrain.GetLevelHeight(node.level))
+                continue;
+
+            glm::vec4 rect = terrain.GetNodeRect(node.level, node.nx, node.nz);
+            Entry e;
+            bool outside = MeasureDistance(rect, e);
+            if (outside && e.dmin > maxDistance) continue;
+
+            float size = std::max(rect.z - rect.x, rect.w - rect.y);
+            if (node.level > 1 && (!outside || size > e.dmin * SUBDIVIDE)) {
+                for (int k = 0; k < 4; k++)
+                    stack.push_back({ node.level - 1, node.nx * 2 + (k & 1), node.nz * 2 + (k >> 1) });
+                continue;
+            }
+            if (!outside) continue;
+
+            if (e.dmax > maxDistance) continue;
+
+            MeasureAngles(rect, e);
+            float dy = terrain.GetNodeRange(node.level, node.nx, node.nz).x - m_camera.y;
+            e.tangent = dy > 0.0f ? dy / e.dmax : dy / e.dmin;
+            e.index = std::lower_bound(m_objectDistance.begin(), m_objectDistance.end(), e.dmax) - m_objectDistance.begin();
+            m_occluders.push_back(e);
+        }
+    }
+
+    // 只写完全落在角度范围内的方位格
+    void Insert(const Entry& e)
+    {
+        int first = static_cast<int>(std::ceil(BinCoord(e.lo)));
+        int last = static_cast<int>(std::floor(BinCoord(e.hi))) - 1;
+        for (int b = first; b <= last; b++) {
+            float& h = m_horizon[Wrap(b)];
+            h = std::max(h, e.tangent);
+        }
+    }
+
+    // 物体碰到的每个方位格都要被挡住
+    bool Occluded(const Entry& e) const
+    {
+        int first = static_cast<int>(std::floor(BinCoord(e.lo)));
+        int last = static_cast<int>(std::floor(BinCoord(e.hi)));
+        for (int b = first; b <= last; b++) {
+            if (m_horizon[Wrap(b)] <= e.tangent)
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif // OCCLUSION_HORIZON_H
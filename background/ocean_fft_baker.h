@@ -16,6 +16,8 @@ private:
     
     unsigned int texture3D_displacement;  // 3D 位移纹理 (xyz)
     unsigned int texture3D_normal;        // 3D 法线纹理
+    glm::vec3 maxDisplacement;            // 所有帧中各轴位移的最大绝对值
+    std::vector<glm::vec3> normalData;    // CPU 端法线 (N x N x T)，供焦散烘焙使用，用完可释放
     
     OceanGerstnerFFT* ocean;
 
@@ -25,7 +27,7 @@ public:
                   float A = 0.0005f,
                   glm::vec2 windDir = glm::vec2(1.0f, 0.5f), 
                   float windSpeed = 30.0f)
-        : N(N), T(T), timeSpan(timeSpan)
+        : N(N), T(T), timeSpan(timeSpan), maxDisplacement(0.0f)
     {
         std::cout << "\n=== Starting FFT Baking ===" << std::endl;
         std::cout << "Spatial Resolution: " << N << "x" << N << std::endl;
@@ -72,7 +74,7 @@ public:
     {
         // 准备数据缓冲 (N x N x T)
         std::vector<glm::vec3> displacementData(N * N * T);
-        std::vector<glm::vec3> normalData(N * N * T);
+        normalData.assign(N * N * T, glm::vec3(0.0f, 1.0f, 0.0f));
         
         std::cout << "\nBaking frames:" << std::endl;
         
@@ -109,6 +111,8 @@ public:
                     // 存储位移量 (不是绝对位置)
                     displacementData[volumeIdx] = vertices[spatialIdx] - originalPos[spatialIdx];
                     normalData[volumeIdx] = normals[spatialIdx];
+
+                    maxDisplacement = glm::max(maxDisplacement, glm::abs(displacementData[volumeIdx]));
                 }
             }
         }
@@ -152,12 +156,19 @@ public:
         std::cout << "GPU Memory: " << memoryMB << " MB" << std::endl;
         std::cout << "Displacement Texture ID: " << texture3D_displacement << std::endl;
         std::cout << "Normal Texture ID: " << texture3D_normal << std::endl;
+        std::cout << "Max displacement: (" << maxDisplacement.x << ", "
+                  << maxDisplacement.y << ", " << maxDisplacement.z << ")" << std::endl;
     }
     
     unsigned int GetDisplacementTexture() const { return texture3D_displacement; }
     unsigned int GetNormalTexture() const { return texture3D_normal; }
     float GetTimeSpan() const { return timeSpan; }
+    glm::vec3 GetMaxDisplacement() const { return maxDisplacement; }
     int GetResolution() const { return N; }
+    int GetFrameCount() const { return T; }
+    const std::vector<glm::vec3>& GetNormalData() const { return normalData; }
+    // 焦散等 CPU 烘焙完成后释放法线数据
+    void ReleaseCPUData() { std::vector<glm::vec3>().swap(normalData); }
 };
 
 #endif // OCEAN_FFT_BAKER_H
\ No newline at end of file
@@ -0,0 +1,603 @@
+#ifndef PAGED_TERRAIN_H
+#define PAGED_TERRAIN_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <shader.h>
+#include <mesh.h>
+#include <frustum.h>
+#include "heightmap_io.h"
+#include "beach_generator.h"
+
+// 分页地形：高度场留在磁盘上（推荐 .hft 分块格式，内存映射读取），只有相机附近的页
+// 由后台线程读出、在主线程上传为小块高度纹理。也可以不读文件，由 BeachTerrainGenerator
+// 在后台线程里按需生成每一页（程序化沙滩）。
+//
+// - 每页 PAGE_QUADS x PAGE_QUADS 个格子，纹理四周多存一圈样本，法线在页边界上连续
+// - 常驻页放在 LRU 缓存里，按显存预算淘汰；淘汰下来的纹理放回池中给新页复用
+// - 远处或尚未加载好的页用启动时生成的整张低分辨率代理高度图绘制，不会出现空洞，也不会卡住加载
+// - 绘制复用 terrain.vs 的 CDLOD 路径（一块 patch + 节点矩形），关闭形变
+//
+// 坐标约定与 Terrain 相同：样本 (x, z) 位于 ((x - width/2) * horizontalScale, (z - height/2) * horizontalScale)。
+// 细节页与代理之间的边界没有缝合，高度差在代理分辨率的误差以内。
+// 高度查询和拾取直接读同一份数据（文件或生成器），与绘制出的地面一致；数据按原样使用，不做 Terrain 的深水过渡。
+class PagedTerrain
+{
+public:
+    static const int PAGE_QUADS = 64;           // 每页格子数
+    static const int PAGE_TEXELS = PAGE_QUADS + 3;  // 页纹理边长：PAGE_QUADS+1 个样本 + 两侧各一圈
+    static const int PROXY_BLOCK = 4;           // 代理按 PROXY_BLOCK x PROXY_BLOCK 页合批绘制
+    static const int BLOCK_PATCH_QUADS = 32;    // 整块代理使用的 patch
+    static const int PAGE_PROXY_QUADS = 8;      // 单页代理使用的 patch
+
+    PagedTerrain(const std::string& path, const std::vector<Texture>& textures,
+                 float heightScale, float horizontalScale,
+                 int detailRadius = 4, size_t memoryBudgetMB = 64, int proxyResolution = 1024,
+                 int workerCount = 2)
+        : m_textures(textures), m_heightScale(heightScale), m_horizontalScale(horizontalScale),
+          m_detailRadius(detailRadius), m_budgetBytes(memoryBudgetMB * 1024 * 1024)
+    {
+        if (!m_file.Open(path)) {
+            std::cout << "Failed to open paged heightmap: " << path << std::endl;
+            return;
+        }
+        Init(m_file.GetWidth(), m_file.GetHeight(), proxyResolution, workerCount, m_file.GetFormatName());
+    }
+
+    // 程序化来源：width x height 个样本的范围内，页由工作线程调用生成器生成，不读磁盘
+    PagedTerrain(const BeachTerrainGenerator& generator, int width, int height,
+                 const std::vector<Texture>& textures, float heightScale, float horizontalScale,
+                 int detailRadius = 4, size_t memoryBudgetMB = 64, int proxyResolution = 1024,
+                 int workerCount = 2)
+        : m_generator(generator), m_procedural(true), m_textures(textures),
+          m_heightScale(heightScale), m_horizontalScale(horizontalScale),
+          m_detailRadius(detailRadius), m_budgetBytes(memoryBudgetMB * 1024 * 1024)
+    {
+        Init(width, height, proxyResolution, workerCount, "procedural");
+    }
+
+    ~PagedTerrain()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (auto& worker : m_workers) worker.join();
+
+        for (auto& entry : m_pages) glDeleteTextures(1, &entry.second.texture);
+        for (unsigned int tex : m_texturePool) glDeleteTextures(1, &tex);
+        if (m_proxyTex) glDeleteTextures(1, &m_proxyTex);
+        if (m_patchVAO) glDeleteVertexArrays(1, &m_patchVAO);
+        if (m_patchEBO) glDeleteBuffers(1, &m_patchEBO);
+    }
+
+    bool IsValid() const { return m_width > 0; }
+
+    // 每帧调用一次（主线程）：上传后台读好的页，重排加载队列，按预算淘汰
+    void Update(const glm::vec3& cameraPos)
+    {
+        if (!IsValid()) return;
+        m_frame++;
+
+        std::vector<LoadedPage> loaded;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            loaded.swap(m_completed);
+        }
+        for (LoadedPage& page : loaded) {
+            if (m_pages.count(page.key)) continue;
+            Page resident;
+            resident.texture = AcquireTexture();
+            resident.lastUsedFrame = m_frame;
+            glBindTexture(GL_TEXTURE_2D, resident.texture);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, PAGE_TEXELS, PAGE_TEXELS, GL_RED, GL_FLOAT, page.heights.data());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            m_pages[page.key] = resident;
+        }
+
+        // 相机附近需要细节的页，近的优先加载
+        int cx, cz;
+        PageAt(cameraPos, cx, cz);
+        std::vector<std::pair<int, int>> wanted;   // (距离平方, key)
+        for (int pz = cz - m_detailRadius; pz <= cz + m_detailRadius; pz++) {
+            for (int px = cx - m_detailRadius; px <= cx + m_detailRadius; px++) {
+                if (px < 0 || pz < 0 || px >= m_pagesX || pz >= m_pagesZ) continue;
+                int key = pz * m_pagesX + px;
+                auto it = m_pages.find(key);
+                if (it != m_pages.end())
+                    it->second.lastUsedFrame = m_frame;
+                else
+                    wanted.push_back({ (px - cx) * (px - cx) + (pz - cz) * (pz - cz), key });
+            }
+        }
+        std::sort(wanted.begin(), wanted.end());
+
+        {
+            // 旧请求直接作废，只保留当前仍需要的页
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_requests.clear();
+            for (auto& w : wanted) {
+                if (!m_inFlight.count(w.second))
+                    m_requests.push_back(w.second);
+            }
+        }
+        m_cv.notify_all();
+
+        EvictToBudget();
+    }
+
+    void Draw(Shader& shader, const glm::mat4& viewProj, const glm::vec3& cameraPos)
+    {
+        BindTextures(shader);
+        DrawPages(shader, viewProj, cameraPos);
+    }
+
+    void DrawDepth(Shader& shader, const glm::mat4& lightSpaceMatrix, const glm::vec3& cameraPos)
+    {
+        DrawPages(shader, lightSpaceMatrix, cameraPos);
+    }
+
+    // 统计
+    int GetResidentPageCount() const { return static_cast<int>(m_pages.size()); }
+    size_t GetResidentBytes() const { return (m_pages.size() + m_texturePool.size()) * PageBytes(); }
+    int GetPendingPageCount()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return static_cast<int>(m_requests.size() + m_inFlight.size());
+    }
+    int GetDrawCount() const { return m_drawCount; }
+    float GetWorldWidth() const { return (m_width - 1) * m_horizontalScale; }
+    float GetWorldLength() const { return (m_height - 1) * m_horizontalScale; }
+
+    // 双线性插值的世界高度，超出地形时取最近边缘的值（与 Terrain::SampleHeight 一致）。
+    // 直接读文件或调用生成器，与页是否常驻无关，可以在任意线程调用
+    float SampleHeight(float x, float z) const
+    {
+        float gx = glm::clamp((x - m_originX) / m_horizontalScale, 0.0f, static_cast<float>(m_width - 1));
+        float gz = glm::clamp((z - m_originZ) / m_horizontalScale, 0.0f, static_cast<float>(m_height - 1));
+        int x0 = std::min(static_cast<int>(gx), std::max(m_width - 2, 0));
+        int z0 = std::min(static_cast<int>(gz), std::max(m_height - 2, 0));
+        float s[4];
+        ReadQuad(x0, z0, s);
+        float fx = gx - x0, fz = gz - z0;
+        return glm::mix(glm::mix(s[0], s[1], fx), glm::mix(s[2], s[3], fx), fz) * m_heightScale;
+    }
+
+    void SampleHeights(const float* xs, const float* zs, float* heights, size_t count) const
+    {
+        for (size_t i = 0; i < count; i++)
+            heights[i] = SampleHeight(xs[i], zs[i]);
+    }
+
+    // 射线与地形表面的最近交点，参数同 Terrain::Raycast。没有整张图的 min/max 四叉树：
+    // 先裁剪到地形包围盒，再按一个样本间距步进，穿过地面后二分细化
+    bool Raycast(const glm::vec3& origin, const glm::vec3& dir, glm::vec3& hitPoint, float maxT = 10000.0f) const
+    {
+        if (!IsValid()) return false;
+        glm::vec3 bmin(m_originX, m_minHeight, m_originZ);
+        glm::vec3 bmax(m_originX + GetWorldWidth(), m_maxHeight, m_originZ + GetWorldLength());
+        float t0 = 0.0f, t1 = maxT;
+        for (int i = 0; i < 3; i++) {
+            if (std::abs(dir[i]) < 1e-8f) {
+                if (origin[i] < bmin[i] || origin[i] > bmax[i]) return false;
+                continue;
+            }
+            float ta = (bmin[i] - origin[i]) / dir[i], tb = (bmax[i] - origin[i]) / dir[i];
+            t0 = std::max(t0, std::min(ta, tb));
+            t1 = std::min(t1, std::max(ta, tb));
+        }
+        if (t0 > t1) return false;
+
+        // 射线在地面以上的高度，<= 0 表示已经到了地下
+        auto clearance = [&](float t) {
+            glm::vec3 p = origin + dir * t;
+            return p.y - SampleHeight(p.x, p.z);
+        };
+        float step = m_horizontalScale / std::max(glm::length(glm::vec2(dir.x, dir.z)), std::abs(dir.y));
+        int steps = std::max(1, static_cast<int>(std::ceil((t1 - t0) / step)));
+        float prevT = t0;
+        bool hit = clearance(t0) <= 0.0f;
+        float hitT = t0;
+        for (int i = 1; i <= steps && !hit; i++) {
+            float t = t0 + (t1 - t0) * i / steps;
+            if (clearance(t) <= 0.0f) {
+                float lo = prevT, hi = t;
+                for (int k = 0; k < 12; k++) {
+                    float mid = 0.5f * (lo + hi);
+                    if (clearance(mid) <= 0.0f) hi = mid;
+                    else lo = mid;
+                }
+                hit = true;
+                hitT = hi;
+            }
+            prevT = t;
+        }
+        if (!hit) return false;
+        hitPoint = origin + dir * hitT;
+        hitPoint.y = SampleHeight(hitPoint.x, hitPoint.z);
+        return true;
+    }
+
+    // 启动时生成的低分辨率代理（归一化高度），岸线距离场等需要整张图的烘焙用它
+    const std::vector<float>& GetProxyHeights() const { return m_proxyHeights; }
+    int GetProxyWidth() const { return m_proxyWidth; }
+    int GetProxyHeight() const { return m_proxyHeight; }
+    float GetProxySpacing() const { return m_proxyLod * m_horizontalScale; }
+    float GetHeightScale() const { return m_heightScale; }
+    float GetHorizontalScale() const { return m_horizontalScale; }
+
+private:
+    struct Page
+    {
+        unsigned int texture = 0;
+        int lastUsedFrame = 0;
+    };
+
+    struct LoadedPage
+    {
+        int key;
+        std::vector<float> heights;   // PAGE_TEXELS^2 个归一化高度
+    };
+
+    HeightmapFile m_file;
+    BeachTerrainGenerator m_generator;
+    bool m_procedural = false;
+    std::vector<Texture> m_textures;
+    int m_width = 0, m_height = 0;
+    float m_heightScale, m_horizontalScale;
+    float m_originX = 0.0f, m_originZ = 0.0f;
+    int m_pagesX = 0, m_pagesZ = 0;
+    int m_detailRadius;
+    size_t m_budgetBytes;
+    int m_frame = 0;
+    int m_drawCount = 0;
+
+    // 常驻页与纹理池（仅主线程访问）
+    std::unordered_map<int, Page> m_pages;
+    std::vector<unsigned int> m_texturePool;
+
+    // 后台加载（m_mutex 保护）
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<int> m_requests;
+    std::unordered_set<int> m_inFlight;
+    std::vector<LoadedPage> m_completed;
+    bool m_stop = false;
+
+    // 低分辨率代理
+    unsigned int m_proxyTex = 0;
+    int m_proxyWidth = 0, m_proxyHeight = 0, m_proxyLod = 1;
+    std::vector<float> m_proxyHeights;
+    float m_minHeight = 0.0f, m_maxHeight = 0.0f;   // 拾取用的世界高度范围
+
+    // 三种 patch 共用一个索引缓冲
+    unsigned int m_patchVAO = 0, m_patchEBO = 0;
+    unsigned int m_pageOffset = 0, m_pageCount = 0;
+    unsigned int m_blockOffset = 0, m_blockCount = 0;
+    unsigned int m_pageProxyOffset = 0, m_pageProxyCount = 0;
+
+    static size_t PageBytes() { return static_cast<size_t>(PAGE_TEXELS) * PAGE_TEXELS * sizeof(float); }
+
+    void Init(int width, int height, int proxyResolution, int workerCount, const char* sourceName)
+    {
+        m_width = width;
+        m_height = height;
+        m_pagesX = (m_width - 1 + PAGE_QUADS - 1) / PAGE_QUADS;
+        m_pagesZ = (m_height - 1 + PAGE_QUADS - 1) / PAGE_QUADS;
+        m_originX = -m_width / 2.0f * m_horizontalScale;
+        m_originZ = -m_height / 2.0f * m_horizontalScale;
+
+        BuildProxy(proxyResolution);
+        BuildPatches();
+
+        for (int i = 0; i < std::max(1, workerCount); i++)
+            m_workers.emplace_back(&PagedTerrain::WorkerLoop, this);
+
+        std::cout << "Paged terrain: " << m_width << "x" << m_height << " (" << sourceName << "), "
+                  << m_pagesX << "x" << m_pagesZ << " pages, proxy " << m_proxyWidth << "x" << m_proxyHeight
+                  << ", budget " << m_budgetBytes / (1024 * 1024) << " MB" << std::endl;
+    }
+
+    void PageAt(const glm::vec3& pos, int& px, int& pz) const
+    {
+        px = static_cast<int>(std::floor((pos.x - m_originX) / (m_horizontalScale * PAGE_QUADS)));
+        pz = static_cast<int>(std::floor((pos.z - m_originZ) / (m_horizontalScale * PAGE_QUADS)));
+    }
+
+    void WorkerLoop()
+    {
+        std::vector<float> row(PAGE_TEXELS);
+        while (true) {
+            int key;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this]() { return m_stop || !m_requests.empty(); });
+                if (m_stop) return;
+                key = m_requests.front();
+                m_requests.pop_front();
+                m_inFlight.insert(key);
+            }
+
+            LoadedPage page;
+            page.key = key;
+            LoadPage(key, page.heights, row);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_inFlight.erase(key);
+            m_completed.push_back(std::move(page));
+        }
+    }
+
+    // 样本 (x0, z0) 起 2x2 个归一化高度，按行存放；只有一行或一列时重复边缘样本
+    void ReadQuad(int x0, int z0, float* out) const
+    {
+        if (m_procedural) {
+            m_generator.GenerateRegion(x0, z0, 2, 2, 1, out);
+            return;
+        }
+        int count = std::min(2, m_width - x0);
+        float row[2];
+        m_file.ReadRowSpan(z0, x0, count, row);
+        out[0] = row[0];
+        out[1] = row[count - 1];
+        m_file.ReadRowSpan(std::min(z0 + 1, m_height - 1), x0, count, row);
+        out[2] = row[0];
+        out[3] = row[count - 1];
+    }
+
+    // 读出一页（含外圈）的样本，超出高度图的部分取边缘值；程序化来源直接生成，外圈同样是真实样本
+    void LoadPage(int key, std::vector<float>& heights, std::vector<float>& row) const
+    {
+        int px = key % m_pagesX, pz = key / m_pagesX;
+        int x0 = px * PAGE_QUADS - 1, z0 = pz * PAGE_QUADS - 1;
+        if (m_procedural) {
+            heights.resize(static_cast<size_t>(PAGE_TEXELS) * PAGE_TEXELS);
+            m_generator.GenerateRegion(x0, z0, PAGE_TEXELS, PAGE_TEXELS, 1, heights.data());
+            return;
+        }
+
+        int readX0 = std::max(x0, 0);
+        int readX1 = std::min(x0 + PAGE_TEXELS, m_width);
+        heights.resize(static_cast<size_t>(PAGE_TEXELS) * PAGE_TEXELS);
+
+        for (int lz = 0; lz < PAGE_TEXELS; lz++) {
+            int z = glm::clamp(z0 + lz, 0, m_height - 1);
+            m_file.ReadRowSpan(z, readX0, readX1 - readX0, row.data());
+            float* dst = &heights[static_cast<size_t>(lz) * PAGE_TEXELS];
+            for (int lx = 0; lx < PAGE_TEXELS; lx++) {
+                int x = glm::clamp(x0 + lx, readX0, readX1 - 1);
+                dst[lx] = row[x - readX0];
+            }
+        }
+    }
+
+    unsigned int AcquireTexture()
+    {
+        if (!m_texturePool.empty()) {
+            unsigned int tex = m_texturePool.back();
+            m_texturePool.pop_back();
+            return tex;
+        }
+        unsigned int tex;
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, PAGE_TEXELS, PAGE_TEXELS, 0, GL_RED, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return tex;
+    }
+
+    // 常驻页超出预算时按最久未使用淘汰本帧没用到的页，纹理放回池中；
+    // 池中的空闲纹理同样占显存，超出预算的部分直接释放
+    void EvictToBudget()
+    {
+        size_t pageBytes = PageBytes();
+        if (m_pages.size() * pageBytes > m_budgetBytes) {
+            std::vector<std::pair<int, int>> candidates;   // (上次使用帧, key)
+            for (auto& entry : m_pages) {
+                if (entry.second.lastUsedFrame < m_frame)
+                    candidates.push_back({ entry.second.lastUsedFrame, entry.first });
+            }
+            std::sort(candidates.begin(), candidates.end());
+            for (auto& c : candidates) {
+                if (m_pages.size() * pageBytes <= m_budgetBytes) break;
+                m_texturePool.push_back(m_pages[c.second].texture);
+                m_pages.erase(c.second);
+            }
+        }
+
+        while (!m_texturePool.empty() && GetResidentBytes() > m_budgetBytes) {
+            glDeleteTextures(1, &m_texturePool.back());
+            m_texturePool.pop_back();
+        }
+    }
+
+    void BuildProxy(int resolution)
+    {
+        m_proxyLod = std::max(1, (std::max(m_width, m_height) + resolution - 1) / resolution);
+        std::vector<float>& proxy = m_proxyHeights;
+        if (m_procedural) {
+            // 取每个代理格子中心附近的样本，与 Downsample 的盒式滤波对齐
+            m_proxyWidth = std::max(1, m_width / m_proxyLod);
+            m_proxyHeight = std::max(1, m_height / m_proxyLod);
+            proxy.resize(static_cast<size_t>(m_proxyWidth) * m_proxyHeight);
+            int offset = (m_proxyLod - 1) / 2;
+            m_generator.GenerateRegionParallel(offset, offset, m_proxyWidth, m_proxyHeight, m_proxyLod, proxy.data());
+        } else {
+            m_file.Downsample(m_proxyLod, proxy, m_proxyWidth, m_proxyHeight);
+        }
+        // 代理是盒式平均，峰值比原始样本低，范围至少取满归一化的 [0, 1]
+        auto range = std::minmax_element(proxy.begin(), proxy.end());
+        m_minHeight = std::min(*range.first, 0.0f) * m_heightScale;
+        m_maxHeight = std::max(*range.second, 1.0f) * m_heightScale;
+
+        glGenTextures(1, &m_proxyTex);
+        glBindTexture(GL_TEXTURE_2D, m_proxyTex);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, m_proxyWidth, m_proxyHeight, 0, GL_RED, GL_FLOAT, proxy.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    static void AppendPatch(std::vector<unsigned int>& indices, int quads)
+    {
+        int stride = quads + 1;
+        for (int z = 0; z < quads; z++) {
+            for (int x = 0; x < quads; x++) {
+                unsigned int topLeft = z * stride + x;
+                unsigned int topRight = topLeft + 1;
+                unsigned int bottomLeft = (z + 1) * stride + x;
+                unsigned int bottomRight = bottomLeft + 1;
+
+                indices.push_back(topLeft);
+                indices.push_back(bottomLeft);
+                indices.push_back(topRight);
+
+                indices.push_back(topRight);
+                indices.push_back(bottomLeft);
+                indices.push_back(bottomRight);
+            }
+        }
+    }
+
+    void BuildPatches()
+    {
+        std::vector<unsigned int> indices;
+        m_pageOffset = 0;
+        AppendPatch(indices, PAGE_QUADS);
+        m_pageCount = static_cast<unsigned int>(indices.size());
+        m_blockOffset = m_pageCount;
+        AppendPatch(indices, BLOCK_PATCH_QUADS);
+        m_blockCount = static_cast<unsigned int>(indices.size()) - m_blockOffset;
+        m_pageProxyOffset = m_blockOffset + m_blockCount;
+        AppendPatch(indices, PAGE_PROXY_QUADS);
+        m_pageProxyCount = static_cast<unsigned int>(indices.size()) - m_pageProxyOffset;
+
+        glGenVertexArrays(1, &m_patchVAO);
+        glGenBuffers(1, &m_patchEBO);
+        glBindVertexArray(m_patchVAO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_patchEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glBindVertexArray(0);
+    }
+
+    void BindTextures(Shader& shader)
+    {
+        unsigned int diffuseNr = 1;
+        for (unsigned int i = 0; i < m_textures.size(); i++) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            std::string name = m_textures[i].type;
+            std::string number = (name == "texture_diffuse") ? std::to_string(diffuseNr++) : "1";
+            shader.setInt(name + number, i);
+            glBindTexture(GL_TEXTURE_2D, m_textures[i].id);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // 一个绘制单元：用哪张高度纹理、纹理网格描述、放在哪里、用哪块 patch
+    void DrawPatch(Shader& shader, unsigned int heightTex, const glm::vec4& gridRect, int gridW, int gridH,
+                   const glm::vec4& nodeRect, int patchQuads, unsigned int offset, unsigned int count)
+    {
+        glActiveTexture(GL_TEXTURE12);
+        glBindTexture(GL_TEXTURE_2D, heightTex);
+        shader.setVec4("uGridRect", gridRect);
+        shader.setIVec2("uGridSize", gridW, gridH);
+        shader.setVec4("uNodeRect", nodeRect);
+        shader.setInt("uPatchQuads", patchQuads);
+        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void*)(offset * sizeof(unsigned int)));
+        m_drawCount++;
+    }
+
+    void DrawPages(Shader& shader, const glm::mat4& viewProj, const glm::vec3& cameraPos)
+    {
+        if (!IsValid()) return;
+        Frustum frustum(viewProj);
+
+        shader.setInt("uProceduralGrid", 0);
+        shader.setInt("uCDLOD", 1);
+        shader.setInt("heightMap", 12);
+        shader.setFloat("uHeightScale", m_heightScale);
+        shader.setVec2("uMorphRange", glm::vec2(1e29f, 1e30f));   // 不形变
+        shader.setVec3("uCameraPos", cameraPos);
+        // 纹理坐标按世界坐标平铺，页与页之间连续
+        shader.setVec2("uTexOrigin", glm::vec2(m_originX, m_originZ));
+        shader.setVec2("uTexScale", glm::vec2(1.0f / (PAGE_QUADS * m_horizontalScale)));
+
+        float pageSize = PAGE_QUADS * m_horizontalScale;
+        float proxyStep = m_proxyLod * m_horizontalScale;
+        // 盒式平均后的代理样本位于原始样本块的中心
+        glm::vec4 proxyRect(m_originX + (m_proxyLod - 1) * 0.5f * m_horizontalScale,
+                            m_originZ + (m_proxyLod - 1) * 0.5f * m_horizontalScale, proxyStep, proxyStep);
+
+        int cx, cz;
+        PageAt(cameraPos, cx, cz);
+
+        glBindVertexArray(m_patchVAO);
+        m_drawCount = 0;
+        for (int bz = 0; bz < m_pagesZ; bz += PROXY_BLOCK) {
+            for (int bx = 0; bx < m_pagesX; bx += PROXY_BLOCK) {
+                int bw = std::min(PROXY_BLOCK, m_pagesX - bx);
+                int bh = std::min(PROXY_BLOCK, m_pagesZ - bz);
+                glm::vec3 bmin(m_originX + bx * pageSize, 0.0f, m_originZ + bz * pageSize);
+                glm::vec3 bmax(bmin.x + bw * pageSize, m_heightScale, bmin.z + bh * pageSize);
+                if (!frustum.IntersectsAABB(bmin, bmax)) continue;
+
+                bool nearBlock = bx + bw - 1 >= cx - m_detailRadius && bx <= cx + m_detailRadius &&
+                                 bz + bh - 1 >= cz - m_detailRadius && bz <= cz + m_detailRadius;
+                // 只有完整的块能用一块 patch 画；地图边缘不足 PROXY_BLOCK 页的块逐页画，避免伸出地图
+                bool fullBlock = bw == PROXY_BLOCK && bh == PROXY_BLOCK;
+                if (!nearBlock && fullBlock) {
+                    DrawPatch(shader, m_proxyTex, proxyRect, m_proxyWidth, m_proxyHeight,
+                              glm::vec4(bmin.x, bmin.z, PROXY_BLOCK * pageSize, 0.0f),
+                              BLOCK_PATCH_QUADS, m_blockOffset, m_blockCount);
+                    continue;
+                }
+
+                // 靠近相机的块和边缘块逐页绘制：已常驻的页用细节纹理，其余用代理
+                for (int pz = bz; pz < bz + bh; pz++) {
+                    for (int px = bx; px < bx + bw; px++) {
+                        glm::vec3 pmin(m_originX + px * pageSize, 0.0f, m_originZ + pz * pageSize);
+                        glm::vec3 pmax(pmin.x + pageSize, m_heightScale, pmin.z + pageSize);
+                        if (!frustum.IntersectsAABB(pmin, pmax)) continue;
+
+                        glm::vec4 nodeRect(pmin.x, pmin.z, pageSize, 0.0f);
+                        bool detail = std::abs(px - cx) <= m_detailRadius && std::abs(pz - cz) <= m_detailRadius;
+                        auto it = detail ? m_pages.find(pz * m_pagesX + px) : m_pages.end();
+                        if (it != m_pages.end()) {
+                            glm::vec4 pageRect(pmin.x - m_horizontalScale, pmin.z - m_horizontalScale,
+                                               m_horizontalScale, m_horizontalScale);
+                            DrawPatch(shader, it->second.texture, pageRect, PAGE_TEXELS, PAGE_TEXELS,
+                                      nodeRect, PAGE_QUADS, m_pageOffset, m_pageCount);
+                        } else {
+                            DrawPatch(shader, m_proxyTex, proxyRect, m_proxyWidth, m_proxyHeight,
+                                      nodeRect, PAGE_PROXY_QUADS, m_pageProxyOffset, m_pageProxyCount);
+                        }
+                    }
+                }
+            }
+        }
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+};
+
+#endif // PAGED_TERRAIN_H
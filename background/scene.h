@@ -10,36 +10,86 @@
 #include <texture.h>
 #include <FileSystem.h>
 #include "terrain.h"
+#include "paged_terrain.h"
 #include "waterplane.h"
 #include <ocean_fft_baker.h>
 #include <waterplane_baked.h>
 #include "light.h"
 #include "camera.h"
+#include <skybox.h>
+#include "shoreline.h"
+#include "caustics_baker.h"
 
 using namespace std;
 
+// 水面屏幕空间反射所需的输入，enabled 为 false 时水面仍使用平面反射纹理
+struct ScreenSpaceReflectionParams
+{
+    bool enabled = false;
+    unsigned int sceneColorTexture = 0;  // 不透明部分画完后的屏幕颜色拷贝
+    unsigned int hizTexture = 0;         // 层级最小深度
+    int hizMaxLevel = 0;
+    int maxSteps = 64;
+    float thickness = 2.0f;              // 视空间厚度，光线落在表面后方超过它就不算命中
+    SkyBox* skybox = nullptr;            // 光线离开屏幕时回退到天空盒
+    float dayFactor = 1.0f;
+};
+
+// 反射/折射纹理分帧更新时的重投影参数
+struct WaterReprojectionParams
+{
+    bool reflection = false;     // 反射纹理是旧的
+    bool refraction = false;     // 折射纹理是旧的
+    glm::mat4 historyViewProj = glm::mat4(1.0f);  // 旧纹理渲染时的 projection * view
+};
+
+// 地形高度来源。Paged / Procedural 时不加载整张高度图，绘制、高度查询、拾取和岸线都来自分页地形；
+// 分页文件打不开时退回 Heightmap
+struct TerrainSource
+{
+    enum class Type { Heightmap, Paged, Procedural };
+    Type type = Type::Heightmap;
+    string pagedPath;            // 分页高度图，推荐 .hft（可由 HeightmapFile::WriteTiled 生成）
+    uint32_t seed = 42;          // 程序化沙滩的种子，同一种子每次结果相同
+    int worldSamples = 8193;     // 程序化沙滩每边的样本数
+    int detailRadius = 4;        // 相机周围加载细节页的半径（页）
+    size_t memoryBudgetMB = 64;  // 细节页的显存预算
+};
+
 class Scene
 {
 private:
-    Terrain* terrain;
+    Terrain* terrain = nullptr;  // 整张高度图地形，使用分页地形时为空
     // WaterPlane* waterPlane;  // 水面对象
     OceanBaked* waterPlane;
     OceanFFTBaker* baker;
+    ShorelineField* shoreline = nullptr;
+    CausticsBaker* caustics = nullptr;
+    PagedTerrain* pagedTerrain = nullptr;  // 分页地形，存在时是唯一的高度来源
+    vector<Texture> terrainTextures;
     Shader terrainShader;
     Shader waterShader; 
+    Shader terrainDepthShader;  // 阴影 pass 中绘制地形
         
     float sandheight;
     float groundscale;
     float waterLevel; 
+    bool proceduralGrid;  // 地形与水面是否使用无顶点属性网格
+    bool cdlodTerrain;    // 地形是否使用 CDLOD 四叉树（全分辨率高度图）
 
 public:
     Scene(vector<string> ground_path, 
           float sandheight = 10.0f, 
           float groundscale = 1.0f,
-          float waterLevel = 0.0f)
+          float waterLevel = 0.0f,
+          bool proceduralGrid = true,
+          bool cdlodTerrain = true,
+          const TerrainSource& source = TerrainSource())
         : sandheight(sandheight), 
           groundscale(groundscale),
           waterLevel(waterLevel),
+          proceduralGrid(proceduralGrid),
+          cdlodTerrain(cdlodTerrain),
           terrainShader(
               FileSystem::getPath("background/terrain.vs").c_str(),
               FileSystem::getPath("background/terrain.fs").c_str()
@@ -47,9 +97,13 @@ public:
           waterShader(  // 初始化水面着色器
               FileSystem::getPath("background/water.vs").c_str(),
               FileSystem::getPath("background/water.fs").c_str()
+          ),
+          terrainDepthShader(  // 与主 pass 共用顶点着色器，projection 换成光源矩阵
+              FileSystem::getPath("background/terrain.vs").c_str(),
+              FileSystem::getPath("src/simpleDepthShader.fs").c_str()
           )
     {
-        InitializeScene(ground_path);
+        InitializeScene(ground_path, source);
     }
 
     ~Scene()
@@ -61,24 +115,50 @@ public:
         if (baker) {
             delete baker;
         }
+        delete shoreline;
+        delete caustics;
+        delete pagedTerrain;
+    }
+
+    // 每帧一次：推进分页地形的加载与淘汰，提交本帧的地形形变
+    void Update(const Camera& camera)
+    {
+        if (pagedTerrain)
+            pagedTerrain->Update(camera.Position);
+        if (terrain)
+            terrain->ApplyDeformations();
     }
 
+    PagedTerrain* GetPagedTerrain() const { return pagedTerrain; }
+
     void Draw(Light &light, Camera &camera, float screenWidth, float screenHeight, float time = 0.0f,
               glm::vec4 clipping_plane = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f),
               unsigned int reflectionTexture = 0,
               unsigned int refractionTexture = 0,
               unsigned int depthTexture = 0,
               unsigned int shadowMap = 0,
-              glm::mat4 lightSpaceMatrix = glm::mat4(1.0f)
+              glm::mat4 lightSpaceMatrix = glm::mat4(1.0f),
+              glm::vec2 waterViewportScale = glm::vec2(1.0f),
+              const WaterReprojectionParams* reprojection = nullptr
             ) 
+    {
+        DrawTerrain(light, camera, screenWidth, screenHeight, shadowMap, lightSpaceMatrix, time);
+
+        if (waterPlane && clipping_plane == glm::vec4(0.0f, 0.0f, 0.0f, 0.0f)) {
+            DrawWater(light, camera, screenWidth, screenHeight, time,
+                reflectionTexture, refractionTexture, depthTexture,
+                waterViewportScale, waterViewportScale, nullptr, reprojection);
+        }
+    }
+
+    // 只画地形（不透明部分）
+    void DrawTerrain(Light &light, Camera &camera, float screenWidth, float screenHeight,
+                     unsigned int shadowMap = 0,
+                     glm::mat4 lightSpaceMatrix = glm::mat4(1.0f),
+                     float time = 0.0f)
     {
         glm::mat4 view = camera.GetViewMatrix();
-        glm::mat4 projection = glm::perspective(
-            glm::radians(camera.Zoom), 
-            screenWidth / screenHeight, 
-            0.1f, 
-            10000.0f
-        );
+        glm::mat4 projection = GetProjection(camera, screenWidth, screenHeight);
 
         int is_above = (camera.Position.y > waterPlane->GetHeight());
 
@@ -101,61 +181,200 @@ public:
         glActiveTexture(GL_TEXTURE3);
         glBindTexture(GL_TEXTURE_2D, shadowMap);
         terrainShader.setInt("shadowMap", 3);
+
+        // caustics
+        terrainShader.setInt("useCaustics", caustics ? 1 : 0);
+        terrainShader.setInt("causticsTexture", 13);
+        glActiveTexture(GL_TEXTURE13);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, caustics ? caustics->GetTexture() : 0);
+        if (caustics) {
+            float timeSpan = waterPlane->GetTimeSpan();
+            terrainShader.setInt("causticsLayers", caustics->GetFrameCount());
+            terrainShader.setFloat("causticsTime", fmod(time, timeSpan) / timeSpan);
+            terrainShader.setVec4("causticsRect", waterPlane->GetTexCoordRect());
+            terrainShader.setFloat("causticsStrength", 0.6f);
+            terrainShader.setFloat("waterHeight", waterPlane->GetHeight());
+        }
+
+        // horizon（分页地形没有整张高度图，仍走阴影贴图）
+        const HorizonBaker* horizon = terrain ? terrain->GetHorizonMap() : nullptr;
+        terrainShader.setInt("useHorizonMap", horizon ? 1 : 0);
+        terrainShader.setInt("horizonMap", 14);
+        glActiveTexture(GL_TEXTURE14);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, horizon ? horizon->GetTexture() : 0);
+        if (horizon)
+            terrainShader.setVec4("horizonRect", horizon->GetRect());
+
+        // normal map
+        const TerrainNormalMap* normalMap = terrain ? terrain->GetNormalMap() : nullptr;
+        terrainShader.setInt("useNormalMap", normalMap ? 1 : 0);
+        terrainShader.setInt("normalMap", 15);
+        glActiveTexture(GL_TEXTURE15);
+        glBindTexture(GL_TEXTURE_2D, normalMap ? normalMap->GetTexture() : 0);
+        if (normalMap)
+            terrainShader.setVec4("normalMapRect", normalMap->GetRect());
+        glActiveTexture(GL_TEXTURE0);
         
-        terrain->Draw(terrainShader);
+        if (pagedTerrain)
+            pagedTerrain->Draw(terrainShader, projection * view, camera.Position);
+        else
+            terrain->Draw(terrainShader, projection * view, camera.Position);
+    }
 
-        if (waterPlane && clipping_plane == glm::vec4(0.0f, 0.0f, 0.0f, 0.0f)) {
-            // 启用混合以支持半透明
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            
-            waterShader.use();
-            waterShader.setMat4("model", model);
-            waterShader.setMat4("view", view);
-            waterShader.setMat4("projection", projection);
-            waterShader.setVec3("viewPos", camera.Position);
-            // waterShader.setVec3("light.direction", light.direction);
-            // waterShader.setVec3("light.ambient", light.ambient);
-            // waterShader.setVec3("light.diffuse", light.diffuse);
-            // waterShader.setVec3("light.specular", light.specular);
-            light.SetLight(waterShader);
-            // waterShader.setFloat("time", time);
-            // waterShader.setVec3("waterColor", glm::vec3(0.0f, 0.5f, 0.7f));  // 蓝绿色
-            // waterShader.setVec3("waterColor", glm::vec3(0.5f, 0.6f, 0.8f));  // 淡蓝色
-            // waterShader.setVec3("waterColor_diffuse", glm::vec3(0.8f, 0.9f, 1.0f));
-            waterShader.setFloat("shininess", 32.0f);
-            waterShader.setInt("isAbove", is_above);
-            // printf("isAbove: %d\n", is_above);
-            
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, reflectionTexture);
-            waterShader.setInt("reflectionTexture", 0);
-            
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, refractionTexture);
-            waterShader.setInt("refractionTexture", 1);
-            
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, depthTexture);
-            waterShader.setInt("depthTexture", 2);
-            
-            waterPlane->Draw(waterShader, time);
-            
-            glDisable(GL_BLEND);
+    // 把地形画进阴影贴图（调用前需已绑定阴影 FBO），按光源视锥剔除地形块
+    // cameraPos 为主相机位置，CDLOD 地形据此选择与屏幕上一致的 LOD
+    void DrawTerrainDepth(const glm::mat4& lightSpaceMatrix, const glm::vec3& cameraPos)
+    {
+        // 地形自阴影改由地平线图提供，阴影贴图只需要物体
+        if (terrain && terrain->GetHorizonMap())
+            return;
+
+        terrainDepthShader.use();
+        terrainDepthShader.setMat4("projection", lightSpaceMatrix);
+        terrainDepthShader.setMat4("view", glm::mat4(1.0f));
+        terrainDepthShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
+        terrainDepthShader.setMat4("model", glm::mat4(1.0f));
+        if (pagedTerrain)
+            pagedTerrain->DrawDepth(terrainDepthShader, lightSpaceMatrix, cameraPos);
+        else
+            terrain->DrawDepth(terrainDepthShader, lightSpaceMatrix, cameraPos);
+    }
+
+    // 只画水面（半透明，需在不透明物体之后绘制）
+    // reflectionScale / refractionScale: 两张纹理中实际渲染区域所占比例
+    void DrawWater(Light &light, Camera &camera, float screenWidth, float screenHeight, float time,
+                   unsigned int reflectionTexture,
+                   unsigned int refractionTexture,
+                   unsigned int depthTexture,
+                   glm::vec2 reflectionScale = glm::vec2(1.0f),
+                   glm::vec2 refractionScale = glm::vec2(1.0f),
+                   const ScreenSpaceReflectionParams* ssr = nullptr,
+                   const WaterReprojectionParams* reprojection = nullptr)
+    {
+        if (!waterPlane) return;
+
+        glm::mat4 view = camera.GetViewMatrix();
+        glm::mat4 projection = GetProjection(camera, screenWidth, screenHeight);
+        glm::mat4 model = glm::mat4(1.0f);
+
+        int is_above = (camera.Position.y > waterPlane->GetHeight());
+
+        // 启用混合以支持半透明
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        
+        waterShader.use();
+        waterShader.setMat4("model", model);
+        waterShader.setMat4("view", view);
+        waterShader.setMat4("projection", projection);
+        waterShader.setVec3("viewPos", camera.Position);
+        // waterShader.setVec3("light.direction", light.direction);
+        // waterShader.setVec3("light.ambient", light.ambient);
+        // waterShader.setVec3("light.diffuse", light.diffuse);
+        // waterShader.setVec3("light.specular", light.specular);
+        light.SetLight(waterShader);
+        waterShader.setFloat("time", time);
+        // waterShader.setVec3("waterColor", glm::vec3(0.0f, 0.5f, 0.7f));  // 蓝绿色
+        // waterShader.setVec3("waterColor", glm::vec3(0.5f, 0.6f, 0.8f));  // 淡蓝色
+        // waterShader.setVec3("waterColor_diffuse", glm::vec3(0.8f, 0.9f, 1.0f));
+        waterShader.setFloat("shininess", 32.0f);
+        waterShader.setInt("isAbove", is_above);
+        // printf("isAbove: %d\n", is_above);
+        
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, reflectionTexture);
+        waterShader.setInt("reflectionTexture", 0);
+        
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, refractionTexture);
+        waterShader.setInt("refractionTexture", 1);
+        
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, depthTexture);
+        waterShader.setInt("depthTexture", 2);
+        waterShader.setVec2("reflectionScale", reflectionScale);
+        waterShader.setVec2("refractionScale", refractionScale);
+
+        // 屏幕空间反射：纹理单元即使不用也要分开，避免不同类型的采样器指向同一单元
+        bool useSSR = ssr && ssr->enabled;
+        waterShader.setInt("ssrEnabled", useSSR ? 1 : 0);
+        waterShader.setInt("sceneColorTexture", 4);
+        waterShader.setInt("hizTexture", 5);
+        waterShader.setInt("skyboxTexture", 6);
+        if (useSSR) {
+            glActiveTexture(GL_TEXTURE4);
+            glBindTexture(GL_TEXTURE_2D, ssr->sceneColorTexture);
+            glActiveTexture(GL_TEXTURE5);
+            glBindTexture(GL_TEXTURE_2D, ssr->hizTexture);
+            if (ssr->skybox)
+                ssr->skybox->BindCubemap(GL_TEXTURE6);
+            waterShader.setInt("hizMaxLevel", ssr->hizMaxLevel);
+            waterShader.setInt("ssrMaxSteps", ssr->maxSteps);
+            waterShader.setFloat("ssrThickness", ssr->thickness);
+            waterShader.setFloat("dayFactor", ssr->dayFactor);
         }
+
+        // 海岸线距离场：水深、透明度、泡沫和岸边波浪衰减
+        waterShader.setInt("useShoreline", shoreline ? 1 : 0);
+        waterShader.setInt("shorelineTexture", 7);
+        glActiveTexture(GL_TEXTURE7);
+        glBindTexture(GL_TEXTURE_2D, shoreline ? shoreline->GetTexture() : 0);
+        if (shoreline)
+            waterShader.setVec4("shoreRect", shoreline->GetRect());
+        waterShader.setFloat("shoreDampDistance", 10.0f);
+
+        waterShader.setInt("reprojectReflection", (reprojection && reprojection->reflection) ? 1 : 0);
+        waterShader.setInt("reprojectRefraction", (reprojection && reprojection->refraction) ? 1 : 0);
+        waterShader.setMat4("historyViewProj", reprojection ? reprojection->historyViewProj : projection * view);
+        
+        waterPlane->Draw(waterShader, time, projection * view);
+        
+        glDisable(GL_BLEND);
     }
 
-    float GetHeight(float x, float z) const
+    // 高度查询与拾取：走当前的高度来源（分页地形或整张高度图），与画出来的地面一致
+    float SampleHeight(float x, float z) const
     {
-        return terrain->GetHeight(x, z);
+        return pagedTerrain ? pagedTerrain->SampleHeight(x, z) : terrain->SampleHeight(x, z);
     }
 
+    void SampleHeights(const float* xs, const float* zs, float* heights, size_t count) const
+    {
+        if (pagedTerrain)
+            pagedTerrain->SampleHeights(xs, zs, heights, count);
+        else
+            terrain->SampleHeights(xs, zs, heights, count);
+    }
+
+    bool Raycast(const glm::vec3& origin, const glm::vec3& dir, glm::vec3& hitPoint, float maxT = 10000.0f) const
+    {
+        return pagedTerrain ? pagedTerrain->Raycast(origin, dir, hitPoint, maxT)
+                            : terrain->Raycast(origin, dir, hitPoint, maxT);
+    }
+
+    // 分页地形的数据来自磁盘或生成器，是只读的，只有整张高度图地形支持形变
+    bool CanDeform() const { return pagedTerrain == nullptr; }
+    void Deform(const glm::vec3& center, float radius, float amount)
+    {
+        if (CanDeform())
+            terrain->Deform(center, radius, amount);
+    }
+
+    // 使用分页地形时为空
     Terrain* GetTerrain() const { return terrain; }
     // WaterPlane* GetWaterPlane() const { return waterPlane; }
     OceanBaked* GetWaterPlane() const { return waterPlane; }
 
 private:
-    void InitializeScene(vector<string> ground_path)
+    glm::mat4 GetProjection(const Camera &camera, float screenWidth, float screenHeight) const
+    {
+        return glm::perspective(glm::radians(camera.Zoom), screenWidth / screenHeight, 0.1f, 10000.0f);
+    }
+
+    // 原先的高度图以 1/8 分辨率加载，1 个网格 = groundscale
+    static const int BASE_LOD = 8;
+
+    void InitializeScene(vector<string> ground_path, const TerrainSource& source)
     {
         std::cout << "\n=== Initializing Scene ===" << std::endl;
         
@@ -171,16 +390,50 @@ private:
         }
         
         vector<Texture> textures = textureManager.LoadTexture(texture_paths, types);
+        terrainTextures = textures;
         
         std::cout << "Creating terrain..." << std::endl;
-        terrain = new Terrain(heightmapPath, textures, sandheight, groundscale, 8, -20.0f, 100.0f);
+        // 分页地形的样本与全分辨率高度图同间距（文件头里没有水平缩放）
+        if (source.type == TerrainSource::Type::Paged) {
+            pagedTerrain = new PagedTerrain(source.pagedPath, textures, sandheight, groundscale / BASE_LOD,
+                                            source.detailRadius, source.memoryBudgetMB);
+            if (!pagedTerrain->IsValid()) {
+                delete pagedTerrain;
+                pagedTerrain = nullptr;
+            }
+        } else if (source.type == TerrainSource::Type::Procedural) {
+            // 程序化沙滩：页由后台线程按需生成。海岸线放在中间，穿过世界原点附近；
+            // 水面铺在 +z 半边，海放在 z 更大的一侧
+            BeachProfileParams params;
+            params.shoreZ = source.worldSamples * 0.5f;
+            params.seaTowardPositiveZ = true;
+            pagedTerrain = new PagedTerrain(BeachTerrainGenerator(source.seed, params),
+                                            source.worldSamples, source.worldSamples, textures, sandheight,
+                                            groundscale / BASE_LOD, source.detailRadius, source.memoryBudgetMB);
+        }
+
+        if (!pagedTerrain) {
+            // CDLOD 加载全分辨率，水平缩放与海滩过渡距离按比例换算，保持地形世界尺寸不变
+            int lod = cdlodTerrain ? 1 : BASE_LOD;
+            float lodRatio = static_cast<float>(BASE_LOD) / lod;
+            terrain = new Terrain(heightmapPath, textures, sandheight, groundscale / lodRatio, lod,
+                -20.0f, 100.0f * lodRatio, proceduralGrid, cdlodTerrain);
+        }
+
+        // 海岸线距离场只依赖高度，加载时烘焙一次；分页地形没有整张高度图，用它的低分辨率代理
+        if (pagedTerrain)
+            shoreline = new ShorelineField(pagedTerrain->GetProxyHeights(), pagedTerrain->GetProxyWidth(),
+                pagedTerrain->GetProxyHeight(), sandheight, pagedTerrain->GetProxySpacing(), waterLevel);
+        else
+            shoreline = new ShorelineField(terrain->GetHeightData(), terrain->GetGridWidth(), terrain->GetGridLength(),
+                terrain->GetHeightScale(), terrain->GetHorizontalScale(), waterLevel);
         
         // 创建水面
         std::cout << "Creating water plane..." << std::endl;
         
-        // 获取地形尺寸
-        float terrainWidth = terrain->GetWidth() * groundscale;
-        float terrainLength = terrain->GetHeight() * groundscale / 2.0f;  // Z轴正半轴
+        // 获取地形尺寸（水面和焦散的范围随当前高度来源）
+        float terrainWidth = pagedTerrain ? pagedTerrain->GetWorldWidth() : terrain->GetWorldWidth();
+        float terrainLength = (pagedTerrain ? pagedTerrain->GetWorldLength() : terrain->GetWorldLength()) / 2.0f;  // Z轴正半轴
         
         // 创建水面 (可选: 使用纹理或纯色)
         vector<Texture> waterTextures;  // 空纹理列表,使用纯色
@@ -208,8 +461,19 @@ private:
             waterLevel,
             baker->GetDisplacementTexture(),
             baker->GetNormalTexture(),
-            baker->GetTimeSpan()
+            baker->GetTimeSpan(),
+            baker->GetMaxDisplacement(),
+            16,
+            proceduralGrid
         );
+
+        // 用同一组海面法线烘焙焦散，之后 CPU 端法线不再需要；
+        // 偏移按海面纹理在水面上实际覆盖的尺寸换算，与 terrain.fs 用 causticsRect 采样的坐标一致
+        std::cout << "Baking caustics..." << std::endl;
+        glm::vec4 waterRect = waterPlane->GetTexCoordRect();
+        caustics = new CausticsBaker(baker->GetNormalData(), baker->GetResolution(),
+            baker->GetFrameCount(), glm::vec2(1.0f / waterRect.z, 1.0f / waterRect.w));
+        baker->ReleaseCPUData();
         
         std::cout << "Scene initialization complete!" << std::endl;
     }
@@ -0,0 +1,153 @@
+#ifndef SHORELINE_H
+#define SHORELINE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <iostream>
+#include <parallel.h>
+
+// 海岸线有向距离场：从地形高度图烘焙，水面着色器用它代替深度缓冲
+//   R: 到海岸线的有向距离（世界单位），水中为正，陆地为负
+//   G: 水深（水面高度 - 地形高度，世界单位），陆地为负
+class ShorelineField
+{
+public:
+    ShorelineField(const std::vector<float>& heightData, int width, int height,
+                   float heightScale, float horizontalScale, float waterLevel)
+        : m_width(width), m_height(height), m_horizontalScale(horizontalScale)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        Bake(heightData, heightScale, waterLevel);
+        Upload();
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "Shoreline field baked: " << m_width << "x" << m_height << " in "
+                  << std::chrono::duration<float, std::milli>(end - start).count() << " ms" << std::endl;
+    }
+
+    ~ShorelineField()
+    {
+        if (m_texture) glDeleteTextures(1, &m_texture);
+    }
+
+    unsigned int GetTexture() const { return m_texture; }
+
+    // 世界坐标 xz 到纹理坐标的映射：uv = (xz - rect.xy) * rect.zw
+    // 与 Terrain 的顶点布局一致：第 c 列顶点位于 (c - width/2) * horizontalScale
+    glm::vec4 GetRect() const
+    {
+        return glm::vec4((-m_width / 2.0f - 0.5f) * m_horizontalScale,
+                         (-m_height / 2.0f - 0.5f) * m_horizontalScale,
+                         1.0f / (m_width * m_horizontalScale),
+                         1.0f / (m_height * m_horizontalScale));
+    }
+
+    float GetDistance(int x, int z) const { return m_field[(z * m_width + x) * 2]; }
+    float GetDepth(int x, int z) const { return m_field[(z * m_width + x) * 2 + 1]; }
+
+private:
+    int m_width, m_height;
+    float m_horizontalScale;
+    std::vector<float> m_field;   // 交错存放 (距离, 水深)
+    unsigned int m_texture = 0;
+
+    static constexpr float INF = 1e20f;
+
+    // Felzenszwalb-Huttenlocher 一维平方距离变换（下包络抛物线），O(n)
+    static void DistanceTransform1D(const float* f, int n, float* d, int* v, float* z)
+    {
+        int k = 0;
+        v[0] = 0;
+        z[0] = -INF;
+        z[1] = INF;
+        for (int q = 1; q < n; q++) {
+            float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+            while (s <= z[k]) {
+                k--;
+                s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+            }
+            k++;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = INF;
+        }
+        k = 0;
+        for (int q = 0; q < n; q++) {
+            while (z[k + 1] < q) k++;
+            float dq = static_cast<float>(q - v[k]);
+            d[q] = dq * dq + f[v[k]];
+        }
+    }
+
+    // 精确二维欧氏平方距离变换：先逐列再逐行，各列/各行相互独立，分给多个线程
+    // grid 输入为 0（特征点）或 INF，输出为到最近特征点的平方距离（单位：纹素）
+    void DistanceTransform2D(std::vector<float>& grid) const
+    {
+        int w = m_width, h = m_height;
+
+        ParallelForRange(w, [&](int begin, int end) {
+            std::vector<float> f(h), d(h), z(h + 1);
+            std::vector<int> v(h);
+            for (int x = begin; x < end; x++) {
+                for (int y = 0; y < h; y++) f[y] = grid[y * w + x];
+                DistanceTransform1D(f.data(), h, d.data(), v.data(), z.data());
+                for (int y = 0; y < h; y++) grid[y * w + x] = d[y];
+            }
+        });
+
+        ParallelForRange(h, [&](int begin, int end) {
+            std::vector<float> f(w), d(w), z(w + 1);
+            std::vector<int> v(w);
+            for (int y = begin; y < end; y++) {
+                float* row = &grid[y * w];
+                std::copy(row, row + w, f.begin());
+                DistanceTransform1D(f.data(), w, d.data(), v.data(), z.data());
+                std::copy(d.begin(), d.end(), row);
+            }
+        });
+    }
+
+    void Bake(const std::vector<float>& heightData, float heightScale, float waterLevel)
+    {
+        int count = m_width * m_height;
+        std::vector<float> toLand(count), toWater(count);
+        for (int i = 0; i < count; i++) {
+            bool land = heightData[i] * heightScale > waterLevel;
+            toLand[i] = land ? 0.0f : INF;
+            toWater[i] = land ? INF : 0.0f;
+        }
+
+        DistanceTransform2D(toLand);
+        DistanceTransform2D(toWater);
+
+        // 两个变换之差得到有向距离；各减半个纹素，让零点落在陆地与水的分界处。
+        // 全是水或全是陆地时另一侧的变换保持 INF，限制到地图对角线，否则存成 RG16F 后溢出为 inf，着色器中变成 NaN
+        float maxDistance = std::sqrt(static_cast<float>(m_width) * m_width + static_cast<float>(m_height) * m_height);
+        m_field.resize(count * 2);
+        ParallelFor(count, [&](int i) {
+            float dist;
+            if (toLand[i] > 0.0f)
+                dist = std::sqrt(toLand[i]) - 0.5f;      // 水中
+            else
+                dist = -(std::sqrt(toWater[i]) - 0.5f);  // 陆地
+            dist = glm::clamp(dist, -maxDistance, maxDistance);
+            m_field[i * 2] = dist * m_horizontalScale;
+            m_field[i * 2 + 1] = waterLevel - heightData[i] * heightScale;
+        }, 4096);
+    }
+
+    void Upload()
+    {
+        glGenTextures(1, &m_texture);
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, m_width, m_height, 0, GL_RG, GL_FLOAT, m_field.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+};
+
+#endif // SHORELINE_H
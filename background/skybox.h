@@ -37,6 +37,12 @@ public:
 
     void Render(Camera *reflectionCamera = nullptr, glm::mat4* customProjMatrix = nullptr, int isabove = 1, float currentDayFactor = 1.);
 
+    // 把天空盒立方体贴图绑定到指定纹理单元（供水面反射回退采样）
+    void BindCubemap(GLenum TextureUnit) const
+    {
+        m_pCubemapTex->Bind(TextureUnit);
+    }
+
 private:
     void SetupSkyboxMesh();
     
@@ -33,6 +33,58 @@ uniform sampler2D shadowMap;
 uniform float shininess;
 uniform int isAbove;
 
+// 烘焙的循环焦散（纹理数组，每层一帧，与海面法线同步）
+uniform int useCaustics;
+uniform sampler2DArray causticsTexture;
+uniform int causticsLayers;
+uniform float causticsTime;     // [0, 1) 循环时间，与 water.vs 的 uTime 相同
+uniform vec4 causticsRect;      // 世界 xz 到海面纹理坐标：uv = (xz - rect.xy) * rect.zw
+uniform float causticsStrength;
+uniform float waterHeight;
+
+// 烘焙的地平线图：8 个方位的地平线仰角 / (π/2)，方位 i 为 i * 45°（从 +X 转向 +Z）
+uniform int useHorizonMap;
+uniform sampler2DArray horizonMap;
+uniform vec4 horizonRect;       // 世界 xz 到地平线图纹理坐标：uv = (xz - rect.xy) * rect.zw
+
+// 高分辨率法线图（RG8 存 xz，128 对应 0），网格降采样后补回逐像素的光照细节
+uniform int useNormalMap;
+uniform sampler2D normalMap;
+uniform vec4 normalMapRect;     // 世界 xz 到法线图纹理坐标：uv = (xz - rect.xy) * rect.zw
+
+const float PI = 3.14159265;
+
+void SampleHorizon(vec2 uv, out float h[8])
+{
+    vec4 a = texture(horizonMap, vec3(uv, 0.0));
+    vec4 b = texture(horizonMap, vec3(uv, 1.0));
+    h[0] = a.r; h[1] = a.g; h[2] = a.b; h[3] = a.a;
+    h[4] = b.r; h[5] = b.g; h[6] = b.b; h[7] = b.a;
+}
+
+// 太阳高度角高于该方位的地平线即可见，在相邻两个方位之间插值
+float HorizonSunVisibility(float h[8], vec3 lightDir)
+{
+    float azimuth = atan(lightDir.z, lightDir.x);
+    float f = mod(azimuth / (PI * 0.25) + 8.0, 8.0);
+    int i0 = int(f) % 8;
+    int i1 = (i0 + 1) % 8;
+    float horizon = mix(h[i0], h[i1], fract(f)) * (PI * 0.5);
+    float elevation = asin(clamp(lightDir.y, -1.0, 1.0));
+    return smoothstep(horizon - 0.03, horizon + 0.03, elevation);
+}
+
+// 各方位可见天空的比例（余弦加权）
+float HorizonOcclusion(float h[8])
+{
+    float visible = 0.0;
+    for (int i = 0; i < 8; i++) {
+        float c = cos(h[i] * (PI * 0.5));
+        visible += c * c;
+    }
+    return visible / 8.0;
+}
+
 // 阴影计算函数（带 PCF 软阴影）
 float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir)
 {
@@ -79,7 +131,7 @@ float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir)
 }
 
 // 修改：定向光计算（添加阴影）
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, float shadow)
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, float shadow, float ao)
 {
     vec3 lightDir = normalize(-light.direction);
     
@@ -91,11 +143,11 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, float shadow)
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
     
     // 合并结果
-    vec3 ambient  = light.ambient  * texture(texture_diffuse1, TexCoords).rgb;
+    vec3 ambient  = light.ambient  * ao * texture(texture_diffuse1, TexCoords).rgb;
     vec3 diffuse  = light.diffuse  * diff * texture(texture_diffuse1, TexCoords).rgb;
     vec3 specular = light.specular * spec * vec3(0.5);
     
-    // 阴影只影响漫反射和镜面反射，不影响环境光
+    // 阴影只影响漫反射和镜面反射，环境光只受 AO 影响
     return ambient + (1.0 - shadow) * (diffuse + specular);
 }
 
@@ -127,21 +179,63 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     return (ambient + diffuse + specular);
 }
 
+// 水面以下的焦散：固定两次纹理采样（相邻两帧插值）
+vec3 CalcCaustics(vec3 normal, vec3 lightDir, float shadow)
+{
+    float depthBelow = waterHeight - FragPos.y;
+
+    // 沿折射后的光线方向回到水面，找到照亮该点的那块海面
+    vec3 refracted = refract(-lightDir, vec3(0.0, 1.0, 0.0), 1.0 / 1.33);
+    vec2 surfaceXZ = FragPos.xz + refracted.xz * depthBelow / min(refracted.y, -0.1);
+    vec2 uv = (surfaceXZ - causticsRect.xy) * causticsRect.zw;
+
+    // 与 3D 海面纹理的 GL_REPEAT 线性插值保持一致
+    float layer = causticsTime * float(causticsLayers) - 0.5;
+    float l0 = floor(layer);
+    float f = layer - l0;
+    float a = texture(causticsTexture, vec3(uv, mod(l0, float(causticsLayers)))).r;
+    float b = texture(causticsTexture, vec3(uv, mod(l0 + 1.0, float(causticsLayers)))).r;
+    float caustic = mix(a, b, f);
+
+    // 刚入水处焦散还未成形，深处被散射吸收
+    float fade = smoothstep(0.0, 1.0, depthBelow) * exp(-depthBelow * 0.04);
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 albedo = texture(texture_diffuse1, TexCoords).rgb;
+    return dirLight.diffuse * albedo * diff * (caustic - 1.0) * causticsStrength * fade * (1.0 - shadow);
+}
+
 void main()
 {
     vec3 norm = normalize(Normal);
+    if (useNormalMap == 1) {
+        vec2 n = (texture(normalMap, (FragPos.xz - normalMapRect.xy) * normalMapRect.zw).rg * 255.0 - 128.0) / 127.0;
+        norm = vec3(n.x, sqrt(max(1.0 - dot(n, n), 0.0)), n.y);
+    }
     vec3 viewDir = normalize(viewPos - FragPos);
     
     // 计算定向光的阴影
     vec3 lightDir = normalize(-dirLight.direction);
     float shadow = ShadowCalculation(FragPosLightSpace, norm, lightDir);
+
+    // 地形自阴影和 AO 来自地平线图，阴影贴图里只剩物体
+    float ao = 1.0;
+    if (useHorizonMap == 1) {
+        float h[8];
+        SampleHorizon((FragPos.xz - horizonRect.xy) * horizonRect.zw, h);
+        shadow = max(shadow, 1.0 - HorizonSunVisibility(h, lightDir));
+        ao = HorizonOcclusion(h);
+    }
     
     // Phase 1: 定向光（带阴影）
-    vec3 result = CalcDirLight(dirLight, norm, viewDir, shadow);
+    vec3 result = CalcDirLight(dirLight, norm, viewDir, shadow, ao);
     
     // Phase 2: 点光源（暂不支持阴影，可以添加）
     for(int i = 0; i < NR_POINT_LIGHTS; i++)
         result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);
+
+    // Phase 3: 水下焦散
+    if (useCaustics == 1 && FragPos.y < waterHeight)
+        result = max(result + CalcCaustics(norm, lightDir, shadow), vec3(0.0));
     
     FragColor = vec4(result, 1.0);
     
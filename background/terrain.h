@@ -15,10 +15,36 @@
 #include <iostream>
 #include <shader.h>
 #include <mesh.h>
+#include <frustum.h>
+#include "heightmap_io.h"
+#include "terrain_cache.h"
+#include "cdlod.h"
+#include "heightfield_normals.h"
+#include "heightfield_sampler.h"
+#include "heightfield_raycast.h"
+#include "horizon_baker.h"
+#include "terrain_normal_map.h"
 #define PI 3.14159265359f
 
 using namespace std;
 
+// 地形块：共享同一组顶点，按块剔除后用 baseVertex 提交
+struct TerrainChunk
+{
+    glm::vec3 aabbMin;
+    glm::vec3 aabbMax;
+    int baseVertex;     // 块左上角顶点在整张网格中的下标
+    int pattern;        // 使用的共享索引模板
+};
+
+// 共享索引模板：以整张网格的行宽为步长描述一个 (quadsX x quadsZ) 块，所有同尺寸块共用
+struct ChunkIndexPattern
+{
+    int quadsX, quadsZ;
+    unsigned int indexOffset;
+    unsigned int indexCount;
+};
+
 class Terrain
 {
 public:
@@ -26,13 +52,38 @@ public:
             float heightScale = 10.0f, float horizontalScale = 1.0f,
             int lodLevel = 1,// 添加 LOD 级别参数
             float deepwaterHeight = -1.0f,
-            float maxDistance = 0.8f
+            float maxDistance = 0.8f,
+            bool proceduralGrid = false,  // 无顶点属性模式：只上传高度纹理和索引
+            bool cdlod = false,           // CDLOD 四叉树模式：只上传高度纹理和一块 patch
+            bool useCache = true          // 读写高度图旁边的二进制缓存
         )  
         : m_heightScale(heightScale), m_horizontalScale(horizontalScale), m_lodLevel(lodLevel),
-        m_deepwaterHeight(deepwaterHeight), maxDistance(maxDistance)
+        m_deepwaterHeight(deepwaterHeight), maxDistance(maxDistance), m_procedural(proceduralGrid),
+        m_cdlod(cdlod)
     {
-        LoadHeightmap(heightmapPath);
-        GenerateMesh(textures);
+        // 有匹配的缓存时只做 I/O：映射文件，把高度复制出来，顶点/索引直接从映射内存上传
+        uint64_t cacheKey = useCache ? CacheKey(heightmapPath) : 0;
+        std::string cachePath = TerrainCache::CachePath(heightmapPath, cacheKey);
+        if (!cacheKey || !LoadCache(cachePath, cacheKey, textures)) {
+            NormalMapTexels normals;
+            LoadHeightmap(heightmapPath, normals);
+            vector<Vertex> vertices;
+            vector<unsigned int> indices;
+            if (!m_cdlod) {
+                if (!m_procedural)
+                    BuildVertices(vertices);
+                indices = BuildChunks();
+            }
+            if (cacheKey)
+                SaveCache(cachePath, cacheKey, vertices, indices, normals);
+            Upload(textures, vertices.data(), vertices.size(), indices.data(), indices.size());
+            if (!normals.texels.empty())
+                CreateNormalMap(normals.texels.data(), normals.width, normals.height, normals.cellsPerTexel);
+        }
+
+        m_sampler = new HeightfieldSampler(heightData, m_width, m_height, m_heightScale, m_horizontalScale);
+        m_rayCaster = new HeightfieldRayCaster(heightData, m_width, m_height, m_heightScale, m_horizontalScale);
+        m_horizon = new HorizonBaker(heightData, m_width, m_height, m_heightScale, m_horizontalScale);
     }
 
     ~Terrain() 
@@ -41,30 +92,167 @@ public:
             delete m_mesh;
             m_mesh = nullptr;
         }
+        if (m_gridVAO) glDeleteVertexArrays(1, &m_gridVAO);
+        if (m_gridEBO) glDeleteBuffers(1, &m_gridEBO);
+        if (m_heightTex) glDeleteTextures(1, &m_heightTex);
+        if (m_patchVAO) glDeleteVertexArrays(1, &m_patchVAO);
+        if (m_patchEBO) glDeleteBuffers(1, &m_patchEBO);
+        delete m_quadtree;
+        delete m_sampler;
+        delete m_rayCaster;
+        delete m_horizon;
+        delete m_normalMap;
     }
 
+    // 不做剔除，提交所有块（CDLOD 模式沿用上一次的相机位置选择节点）
     void Draw(Shader& shader)
     {
-        if (m_mesh) {
-            m_mesh->Draw(shader);
-        }
+        BindTextures(shader);
+        if (m_cdlod)
+            DrawCDLOD(shader, m_lastCameraPos, nullptr);
+        else
+            DrawChunks(shader, nullptr);
     }
 
-    float GetHeight(float x, float z) const
+    // 只提交与 viewProj 视锥相交的块
+    void Draw(Shader& shader, const glm::mat4& viewProj)
     {
-        int col = static_cast<int>((x / m_horizontalScale) + m_width / 2.0f);
-        int row = static_cast<int>((z / m_horizontalScale) + m_height / 2.0f);
-        
-        if (col >= 0 && col < m_width && row >= 0 && row < m_height) {
-            return heightData[row * m_width + col] * m_heightScale;
+        Draw(shader, viewProj, m_lastCameraPos);
+    }
+
+    // cameraPos 决定 CDLOD 的节点选择与形变，其它模式忽略
+    void Draw(Shader& shader, const glm::mat4& viewProj, const glm::vec3& cameraPos)
+    {
+        Frustum frustum(viewProj);
+        BindTextures(shader);
+        if (m_cdlod)
+            DrawCDLOD(shader, cameraPos, &frustum);
+        else
+            DrawChunks(shader, &frustum);
+    }
+
+    // 阴影等只写深度的 pass：不绑定漫反射纹理，按光源视锥剔除
+    void DrawDepth(Shader& shader, const glm::mat4& lightSpaceMatrix)
+    {
+        DrawDepth(shader, lightSpaceMatrix, m_lastCameraPos);
+    }
+
+    // CDLOD 模式下用主相机位置选 LOD，使阴影与屏幕上的地形几何一致
+    void DrawDepth(Shader& shader, const glm::mat4& lightSpaceMatrix, const glm::vec3& cameraPos)
+    {
+        Frustum frustum(lightSpaceMatrix);
+        if (m_cdlod)
+            DrawCDLOD(shader, cameraPos, &frustum);
+        else
+            DrawChunks(shader, &frustum);
+    }
+
+    // 双线性插值的世界高度/法线/坡度角（弧度），超出地形时取最近边缘的值
+    float SampleHeight(float x, float z) const { return m_sampler->GetHeight(x, z); }
+    glm::vec3 SampleNormal(float x, float z) const { return m_sampler->GetNormal(x, z); }
+    float SampleSlope(float x, float z) const { return m_sampler->GetSlope(x, z); }
+
+    // 批量查询，见 HeightfieldSampler::SampleHeights / Sample
+    void SampleHeights(const float* xs, const float* zs, float* heights, size_t count) const
+    {
+        m_sampler->SampleHeights(xs, zs, heights, count);
+    }
+    const HeightfieldSampler& GetSampler() const { return *m_sampler; }
+    const HeightfieldRayCaster& GetRayCaster() const { return *m_rayCaster; }
+
+    // 射线与地形表面的最近交点，dir 无需归一化，t 的范围为 [0, maxT]
+    bool Raycast(const glm::vec3& origin, const glm::vec3& dir, glm::vec3& hitPoint, float maxT = 10000.0f) const
+    {
+        return m_rayCaster->Raycast(origin, dir, maxT, hitPoint);
+    }
+
+    // 局部形变：以 center（只用 x/z）为圆心、radius 为半径的笔刷，权重从中心的 1 平滑降到边缘的 0。
+    // 修改立即写入 heightData；高度查询、拾取和 GPU 数据在 ApplyDeformations 中按脏矩形增量更新。
+
+    // 抬高（amount > 0）或压低（amount < 0）地面，amount 为中心处的世界高度变化，用于脚印、挖沙
+    void Deform(const glm::vec3& center, float radius, float amount)
+    {
+        float delta = amount / m_heightScale;
+        ApplyBrush(center, radius, [delta](float h, float weight, int, int) {
+            return h + delta * weight;
+        });
+    }
+
+    // 向世界高度 targetHeight 压平，strength 为中心处的插值比例，用于放置重物
+    void Flatten(const glm::vec3& center, float radius, float targetHeight, float strength = 1.0f)
+    {
+        float target = targetHeight / m_heightScale;
+        ApplyBrush(center, radius, [target, strength](float h, float weight, int, int) {
+            return glm::mix(h, target, weight * strength);
+        });
+    }
+
+    // 向 3x3 邻域均值平滑
+    void Smooth(const glm::vec3& center, float radius, float strength = 0.5f)
+    {
+        ApplyBrush(center, radius, [this, strength](float h, float weight, int x, int z) {
+            return glm::mix(h, NeighbourAverage(x, z), weight * strength);
+        });
+    }
+
+    // 每帧一次（主线程）：把本帧累积的形变提交到 GPU 和各查询结构。
+    // 代价只与脏区域面积有关：法线/切线只重算脏矩形外扩一格的范围，只上传这些行
+    void ApplyDeformations()
+    {
+        // 地平线图的重算范围要外扩 MAX_REACH，代价较高：连续形变期间只累积范围，停手后的第一帧再统一重算
+        if (m_dirtyRects.empty() && m_horizonPending) {
+            m_horizon->UpdateRegion(m_horizonDirty.x0, m_horizonDirty.z0, m_horizonDirty.x1, m_horizonDirty.z1);
+            m_horizonPending = false;
+        }
+        // 法线图的 mipmap 同理：形变期间只更新第 0 级，停手后再整体重建
+        if (m_dirtyRects.empty() && m_normalMap)
+            m_normalMap->UpdateMips();
+
+        for (const DirtyRect& rect : m_dirtyRects) {
+            m_sampler->UpdateRegion(heightData, rect.x0, rect.z0, rect.x1, rect.z1);
+            m_rayCaster->UpdateRegion(rect.x0, rect.z0, rect.x1, rect.z1);
+            if (m_quadtree)
+                m_quadtree->UpdateRegion(heightData, rect.x0, rect.z0, rect.x1, rect.z1);
+            UpdateChunkBounds(rect);
+            if (m_mesh)
+                UploadVertexRegion(rect);
+            if (m_heightTex)
+                UploadHeightRegion(rect);
+            if (m_normalMap)
+                m_normalMap->UpdateRegion(heightData, rect.x0, rect.z0, rect.x1, rect.z1);
+
+            if (!m_horizonPending) {
+                m_horizonDirty = rect;
+                m_horizonPending = true;
+            } else {
+                m_horizonDirty.x0 = std::min(m_horizonDirty.x0, rect.x0);
+                m_horizonDirty.z0 = std::min(m_horizonDirty.z0, rect.z0);
+                m_horizonDirty.x1 = std::max(m_horizonDirty.x1, rect.x1);
+                m_horizonDirty.z1 = std::max(m_horizonDirty.z1, rect.z1);
+            }
         }
-        return 0.0f;
+        m_dirtyRects.clear();
     }
 
+    bool HasPendingDeformations() const { return !m_dirtyRects.empty(); }
+
+    // 地平线图（地形自阴影和 AO）
+    const HorizonBaker* GetHorizonMap() const { return m_horizon; }
+    // 逐像素法线（网格降采样或 CDLOD 时才有）
+    const TerrainNormalMap* GetNormalMap() const { return m_normalMap; }
+
     // 获取地形信息
-    int GetWidth() const { return m_width; }
-    int GetHeight() const { return m_height; }
+    int GetGridWidth() const { return m_width; }    // 高度图列数
+    int GetGridLength() const { return m_height; }  // 高度图行数
     glm::vec3 GetCenter() const { return glm::vec3(0.0f, 0.0f, 0.0f); }
+    float GetWorldWidth() const { return (m_width - 1) * m_horizontalScale; }   // X 方向世界尺寸
+    float GetWorldLength() const { return (m_height - 1) * m_horizontalScale; } // Z 方向世界尺寸
+    int GetChunkCount() const { return static_cast<int>(m_chunks.size()); }
+    int GetVisibleChunkCount() const { return m_visibleChunks; }  // CDLOD 模式下为选中的节点数
+    bool IsCDLOD() const { return m_cdlod; }
+    const vector<float>& GetHeightData() const { return heightData; }  // 归一化高度，乘 heightScale 为世界高度
+    float GetHeightScale() const { return m_heightScale; }
+    float GetHorizontalScale() const { return m_horizontalScale; }
     float GetMaxHeight() const 
     {
         float maxH = 0.0f;
@@ -77,6 +265,10 @@ public:
 private:
     vector<float> heightData;
     Mesh* m_mesh = nullptr;
+    HeightfieldSampler* m_sampler = nullptr;  // 高度查询用的分块副本
+    HeightfieldRayCaster* m_rayCaster = nullptr;  // 拾取用的 min/max 四叉树
+    HorizonBaker* m_horizon = nullptr;  // 地平线图
+    TerrainNormalMap* m_normalMap = nullptr;  // 高分辨率法线图
     
     int m_width, m_height;
     int m_lodLevel;  // LOD 级别 (1=全分辨率, 2=半分辨率, 4=1/4分辨率)
@@ -85,65 +277,340 @@ private:
     float m_deepwaterHeight;
     float maxDistance;
 
-    void LoadHeightmap(const std::string& path)
+    // 局部形变：本帧累积、尚未提交的脏矩形（样本坐标，闭区间），相交或相邻的已合并
+    struct DirtyRect
     {
-        int nrChannels;
-        unsigned char* data = stbi_load(path.c_str(), &m_width, &m_height, &nrChannels, 1);
-        
-        if (!data) {
+        int x0, z0, x1, z1;
+    };
+    vector<DirtyRect> m_dirtyRects;
+    vector<Vertex> m_deformVertices;   // 重建脏区域顶点的临时缓冲，跨帧复用
+    DirtyRect m_horizonDirty = { 0, 0, 0, 0 };  // 尚未重算地平线图的形变范围（并集）
+    bool m_horizonPending = false;
+
+    // 无顶点属性模式所需资源
+    bool m_procedural;
+    vector<Texture> m_textures;
+    unsigned int m_gridVAO = 0;
+    unsigned int m_gridEBO = 0;
+    unsigned int m_heightTex = 0;
+
+    // 分块
+    static const int CHUNK_QUADS = 32;  // 每块边长（四边形数）
+    static const int NORMAL_MAP_RESOLUTION = 4096;  // 法线图边长上限（RG8，4096^2 约 32 MB）
+
+    // 加载时烘焙、尚未上传的法线图
+    struct NormalMapTexels
+    {
+        vector<uint8_t> texels;
+        int width = 0, height = 0;
+        float cellsPerTexel = 1.0f;   // 一个纹素对应的网格格数
+    };
+    vector<TerrainChunk> m_chunks;
+    vector<ChunkIndexPattern> m_patterns;
+    int m_visibleChunks = 0;
+
+    // CDLOD
+    bool m_cdlod;
+    static const int PATCH_QUADS = 32;  // patch 边长（四边形数），与叶节点边长相同
+    CDLODQuadtree* m_quadtree = nullptr;
+    unsigned int m_patchVAO = 0;
+    unsigned int m_patchEBO = 0;
+    unsigned int m_patchIndexCount = 0;
+    glm::vec3 m_lastCameraPos = glm::vec3(0.0f);
+
+    // 为某个尺寸的块取得（必要时生成）共享索引模板
+    int GetPattern(int quadsX, int quadsZ, vector<unsigned int>& indices)
+    {
+        for (size_t i = 0; i < m_patterns.size(); i++) {
+            if (m_patterns[i].quadsX == quadsX && m_patterns[i].quadsZ == quadsZ)
+                return static_cast<int>(i);
+        }
+
+        ChunkIndexPattern pattern;
+        pattern.quadsX = quadsX;
+        pattern.quadsZ = quadsZ;
+        pattern.indexOffset = static_cast<unsigned int>(indices.size());
+        for (int z = 0; z < quadsZ; z++) {
+            for (int x = 0; x < quadsX; x++) {
+                int topLeft = z * m_width + x;
+                int topRight = topLeft + 1;
+                int bottomLeft = (z + 1) * m_width + x;
+                int bottomRight = bottomLeft + 1;
+
+                indices.push_back(topLeft);
+                indices.push_back(bottomLeft);
+                indices.push_back(topRight);
+
+                indices.push_back(topRight);
+                indices.push_back(bottomLeft);
+                indices.push_back(bottomRight);
+            }
+        }
+        pattern.indexCount = static_cast<unsigned int>(indices.size()) - pattern.indexOffset;
+        m_patterns.push_back(pattern);
+        return static_cast<int>(m_patterns.size()) - 1;
+    }
+
+    // 切分地形块，计算紧致 AABB，返回所有共享索引模板拼成的索引数组
+    vector<unsigned int> BuildChunks()
+    {
+        vector<unsigned int> indices;
+        m_chunks.clear();
+        m_patterns.clear();
+
+        for (int z0 = 0; z0 < m_height - 1; z0 += CHUNK_QUADS) {
+            for (int x0 = 0; x0 < m_width - 1; x0 += CHUNK_QUADS) {
+                int quadsX = std::min(CHUNK_QUADS, m_width - 1 - x0);
+                int quadsZ = std::min(CHUNK_QUADS, m_height - 1 - z0);
+
+                float minH, maxH;
+                ChunkHeightRange(x0, z0, quadsX, quadsZ, minH, maxH);
+
+                TerrainChunk chunk;
+                chunk.aabbMin = glm::vec3((x0 - m_width / 2.0f) * m_horizontalScale,
+                                          minH * m_heightScale,
+                                          (z0 - m_height / 2.0f) * m_horizontalScale);
+                chunk.aabbMax = glm::vec3((x0 + quadsX - m_width / 2.0f) * m_horizontalScale,
+                                          maxH * m_heightScale,
+                                          (z0 + quadsZ - m_height / 2.0f) * m_horizontalScale);
+                chunk.baseVertex = z0 * m_width + x0;
+                chunk.pattern = GetPattern(quadsX, quadsZ, indices);
+                m_chunks.push_back(chunk);
+            }
+        }
+
+        std::cout << "Terrain split into " << m_chunks.size() << " chunks, "
+                  << m_patterns.size() << " shared index patterns ("
+                  << indices.size() << " indices)" << std::endl;
+        return indices;
+    }
+
+    void ChunkHeightRange(int x0, int z0, int quadsX, int quadsZ, float& minH, float& maxH) const
+    {
+        minH = heightData[z0 * m_width + x0];
+        maxH = minH;
+        for (int z = z0; z <= z0 + quadsZ; z++) {
+            for (int x = x0; x <= x0 + quadsX; x++) {
+                float h = heightData[z * m_width + x];
+                minH = std::min(minH, h);
+                maxH = std::max(maxH, h);
+            }
+        }
+    }
+
+    template <typename Func>
+    void ApplyBrush(const glm::vec3& center, float radius, Func func)
+    {
+        if (radius <= 0.0f || heightData.empty()) return;
+        float gx = center.x / m_horizontalScale + m_width / 2.0f;
+        float gz = center.z / m_horizontalScale + m_height / 2.0f;
+        float gr = radius / m_horizontalScale;
+
+        DirtyRect rect;
+        rect.x0 = std::max(0, static_cast<int>(std::ceil(gx - gr)));
+        rect.z0 = std::max(0, static_cast<int>(std::ceil(gz - gr)));
+        rect.x1 = std::min(m_width - 1, static_cast<int>(std::floor(gx + gr)));
+        rect.z1 = std::min(m_height - 1, static_cast<int>(std::floor(gz + gr)));
+        if (rect.x0 > rect.x1 || rect.z0 > rect.z1) return;
+
+        for (int z = rect.z0; z <= rect.z1; z++) {
+            for (int x = rect.x0; x <= rect.x1; x++) {
+                float d = glm::length(glm::vec2(x - gx, z - gz)) / gr;
+                if (d >= 1.0f) continue;
+                float weight = 0.5f + 0.5f * std::cos(PI * d);   // 中心 1，边缘 0，斜率连续
+                float& h = heightData[static_cast<size_t>(z) * m_width + x];
+                h = func(h, weight, x, z);
+            }
+        }
+        MarkDirty(rect);
+    }
+
+    float NeighbourAverage(int x, int z) const
+    {
+        float sum = 0.0f;
+        int count = 0;
+        for (int zz = std::max(z - 1, 0); zz <= std::min(z + 1, m_height - 1); zz++) {
+            for (int xx = std::max(x - 1, 0); xx <= std::min(x + 1, m_width - 1); xx++) {
+                sum += heightData[static_cast<size_t>(zz) * m_width + xx];
+                count++;
+            }
+        }
+        return sum / count;
+    }
+
+    // 合并相交或相邻的脏矩形，一帧内同一区域的多次修改只提交一次
+    void MarkDirty(DirtyRect rect)
+    {
+        for (size_t i = 0; i < m_dirtyRects.size();) {
+            const DirtyRect& r = m_dirtyRects[i];
+            if (rect.x0 <= r.x1 + 1 && r.x0 <= rect.x1 + 1 && rect.z0 <= r.z1 + 1 && r.z0 <= rect.z1 + 1) {
+                rect.x0 = std::min(rect.x0, r.x0);
+                rect.z0 = std::min(rect.z0, r.z0);
+                rect.x1 = std::max(rect.x1, r.x1);
+                rect.z1 = std::max(rect.z1, r.z1);
+                m_dirtyRects[i] = m_dirtyRects.back();
+                m_dirtyRects.pop_back();
+                i = 0;   // 扩大后可能与之前检查过的矩形相交
+            } else {
+                i++;
+            }
+        }
+        m_dirtyRects.push_back(rect);
+    }
+
+    // 块 (cx, cz) 覆盖样本 [cx * CHUNK_QUADS, cx * CHUNK_QUADS + quadsX]，块边界上的样本属于两侧的块
+    void UpdateChunkBounds(const DirtyRect& rect)
+    {
+        if (m_chunks.empty()) return;
+        int chunksX = (m_width - 2) / CHUNK_QUADS + 1;
+        int chunksZ = (m_height - 2) / CHUNK_QUADS + 1;
+        int cx0 = std::max(0, (rect.x0 - 1) / CHUNK_QUADS), cx1 = std::min(chunksX - 1, rect.x1 / CHUNK_QUADS);
+        int cz0 = std::max(0, (rect.z0 - 1) / CHUNK_QUADS), cz1 = std::min(chunksZ - 1, rect.z1 / CHUNK_QUADS);
+        for (int cz = cz0; cz <= cz1; cz++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                TerrainChunk& chunk = m_chunks[cz * chunksX + cx];
+                const ChunkIndexPattern& pattern = m_patterns[chunk.pattern];
+                float minH, maxH;
+                ChunkHeightRange(cx * CHUNK_QUADS, cz * CHUNK_QUADS, pattern.quadsX, pattern.quadsZ, minH, maxH);
+                chunk.aabbMin.y = minH * m_heightScale;
+                chunk.aabbMax.y = maxH * m_heightScale;
+            }
+        }
+    }
+
+    // 高度变化会改变相邻顶点的中心差分，所以法线区域外扩一格；逐行用 glBufferSubData 上传
+    void UploadVertexRegion(const DirtyRect& rect)
+    {
+        int x0 = std::max(rect.x0 - 1, 0), z0 = std::max(rect.z0 - 1, 0);
+        int x1 = std::min(rect.x1 + 1, m_width - 1), z1 = std::min(rect.z1 + 1, m_height - 1);
+        int w = x1 - x0 + 1, h = z1 - z0 + 1;
+        m_deformVertices.resize(static_cast<size_t>(w) * h);
+
+        for (int z = z0; z <= z1; z++)
+            for (int x = x0; x <= x1; x++)
+                FillVertex(m_deformVertices[static_cast<size_t>(z - z0) * w + (x - x0)], x, z);
+
+        ComputeHeightfieldFramesRegion(heightData, m_width, m_height, m_heightScale, m_horizontalScale,
+            x0, z0, x1, z1,
+            [&](size_t i, const glm::vec3& n, const glm::vec3& t, const glm::vec3& b) {
+                size_t local = (i / m_width - z0) * w + (i % m_width - x0);
+                m_deformVertices[local].Normal = n;
+                m_deformVertices[local].Tangent = t;
+                m_deformVertices[local].Bitangent = b;
+            });
+
+        // 整行宽的区域在缓冲中是连续的，一次上传
+        if (w == m_width) {
+            m_mesh->UpdateVertices(static_cast<size_t>(z0) * m_width, m_deformVertices.data(), m_deformVertices.size());
+            return;
+        }
+        for (int z = z0; z <= z1; z++)
+            m_mesh->UpdateVertices(static_cast<size_t>(z) * m_width + x0, &m_deformVertices[static_cast<size_t>(z - z0) * w], w);
+    }
+
+    // 高度纹理模式：法线在着色器里由高度纹理算出，只需上传脏矩形本身
+    void UploadHeightRegion(const DirtyRect& rect)
+    {
+        glBindTexture(GL_TEXTURE_2D, m_heightTex);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, m_width);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x0, rect.z0, rect.x1 - rect.x0 + 1, rect.z1 - rect.z0 + 1,
+                        GL_RED, GL_FLOAT, &heightData[static_cast<size_t>(rect.z0) * m_width + rect.x0]);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+    // 与 Mesh::Draw 相同的纹理命名规则
+    void BindTextures(Shader& shader)
+    {
+        const vector<Texture>& textures = m_mesh ? m_mesh->textures : m_textures;
+        unsigned int diffuseNr = 1;
+        for (unsigned int i = 0; i < textures.size(); i++) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            string name = textures[i].type;
+            string number = (name == "texture_diffuse") ? std::to_string(diffuseNr++) : "1";
+            shader.setInt(name + number, i);
+            glBindTexture(GL_TEXTURE_2D, textures[i].id);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    void DrawChunks(Shader& shader, const Frustum* frustum)
+    {
+        shader.setInt("uProceduralGrid", m_procedural ? 1 : 0);
+        shader.setInt("uCDLOD", 0);
+        if (m_procedural)
+            SetProceduralUniforms(shader);
+
+        glBindVertexArray(m_procedural ? m_gridVAO : m_mesh->VAO);
+        m_visibleChunks = 0;
+        for (const TerrainChunk& chunk : m_chunks) {
+            if (frustum && !frustum->IntersectsAABB(chunk.aabbMin, chunk.aabbMax)) continue;
+            const ChunkIndexPattern& pattern = m_patterns[chunk.pattern];
+            glDrawElementsBaseVertex(GL_TRIANGLES, pattern.indexCount, GL_UNSIGNED_INT,
+                                     (void*)(pattern.indexOffset * sizeof(unsigned int)), chunk.baseVertex);
+            m_visibleChunks++;
+        }
+        glBindVertexArray(0);
+    }
+
+    // 每个选中节点画一次 patch；只需补齐部分区域的父节点只画对应象限的索引
+    void DrawCDLOD(Shader& shader, const glm::vec3& cameraPos, const Frustum* frustum)
+    {
+        m_lastCameraPos = cameraPos;
+        shader.setInt("uProceduralGrid", 0);
+        shader.setInt("uCDLOD", 1);
+        SetProceduralUniforms(shader);
+        shader.setInt("uPatchQuads", PATCH_QUADS);
+        shader.setVec3("uCameraPos", cameraPos);
+        // 与其它模式一致：漫反射纹理在整块地形上重复 uTexRepeat 次
+        glm::vec2 gridMin(-m_width / 2.0f * m_horizontalScale, -m_height / 2.0f * m_horizontalScale);
+        shader.setVec2("uTexOrigin", gridMin);
+        shader.setVec2("uTexScale", glm::vec2(10.0f / GetWorldWidth(), 10.0f / GetWorldLength()));
+
+        const vector<CDLODSelection>& selection = m_quadtree->Select(cameraPos, frustum);
+        unsigned int quadrantCount = m_patchIndexCount / 4;
+
+        glBindVertexArray(m_patchVAO);
+        m_visibleChunks = 0;
+        for (const CDLODSelection& node : selection) {
+            shader.setVec4("uNodeRect", glm::vec4(node.origin.x, node.origin.z, node.size, 0.0f));
+            shader.setVec2("uMorphRange", m_quadtree->GetMorphRange(node.level));
+
+            unsigned int count = node.quadrant < 0 ? m_patchIndexCount : quadrantCount;
+            unsigned int offset = node.quadrant < 0 ? 0 : node.quadrant * quadrantCount;
+            glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void*)(offset * sizeof(unsigned int)));
+            m_visibleChunks++;
+        }
+        glBindVertexArray(0);
+    }
+
+    void LoadHeightmap(const std::string& path, NormalMapTexels& normals)
+    {
+        HeightmapFile file;
+        if (!file.Open(path)) {
             std::cout << "Failed to load heightmap: " << path << std::endl;
-            std::cout << "Error: " << stbi_failure_reason() << std::endl;
             m_width = m_height = 100;
             heightData.resize(m_width * m_height, 0.0f);
             return;
         }
 
-        std::cout << "Loaded heightmap: " << m_width << "x" << m_height 
-                  << " (" << nrChannels << " channels)" << std::endl;
+        std::cout << "Loaded heightmap: " << file.GetWidth() << "x" << file.GetHeight()
+                  << " (" << file.GetFormatName() << ")" << std::endl;
 
-        // 降采样大型高度图
+        // 降采样大型高度图：按输出行并行，逐行读取源数据
+        file.Downsample(m_lodLevel, heightData, m_width, m_height);
         if (m_lodLevel > 1) {
-            int newWidth = m_width / m_lodLevel;
-            int newHeight = m_height / m_lodLevel;
-            
-            heightData.resize(newWidth * newHeight);
-            
-            for (int z = 0; z < newHeight; z++) {
-                for (int x = 0; x < newWidth; x++) {
-                    int srcX = x * m_lodLevel;
-                    int srcZ = z * m_lodLevel;
-                    int srcIdx = srcZ * m_width + srcX;
-                    int dstIdx = z * newWidth + x;
-                    
-                    heightData[dstIdx] = static_cast<float>(data[srcIdx]) / 255.0f;
-                }
-            }
-            
-            m_width = newWidth;
-            m_height = newHeight;
-            
             std::cout << "Downsampled to: " << m_width << "x" << m_height 
                       << " (LOD " << m_lodLevel << ")" << std::endl;
-        } else {
-            heightData.resize(m_width * m_height);
-            for (int i = 0; i < m_width * m_height; i++) {
-                heightData[i] = static_cast<float>(data[i]) / 255.0f;
-            }
-        }
-        
-        stbi_image_free(data);
-
-        for(int x=0;x<m_width;x++){
-            for(int z=m_height/2+3;z<m_height;z++){
-                int idx = z * m_width + x;
-                int stard_idx = (m_height/2) * m_width + x;
-                float t = std::clamp((z-m_height/2.0f) / maxDistance, 0.0f, 1.0f);
-                t = t*t*(3-2*t); // smoothstep
-                heightData[idx] = heightData[idx]*0.2 + heightData[stard_idx] + (m_deepwaterHeight - heightData[stard_idx]) * t * 0.8;
-                heightData[idx] *= 0.5f;
-                // printf("x:%d z:%d h:%.3f\n", x, z, heightData[idx]);
-            }
         }
+        ShapeDeepWater(heightData, m_width, m_height, 1.0f);
+
+        // 网格降采样后顶点法线丢掉了细节，趁文件还开着从高分辨率数据烘焙法线图；
+        // CDLOD 远处的稀疏 patch 同样只有顶点上的法线，也使用法线图
+        if (m_lodLevel > 1 || m_cdlod)
+            BakeNormalMap(file, normals);
+        file.Close();
         
         float minH = 1.0f, maxH = 0.0f;
         for (float h : heightData) {
@@ -153,170 +620,269 @@ private:
         std::cout << "Height range: " << minH << " to " << maxH << std::endl;
     }
 
-    void GenerateMesh(vector<Texture> m_textures)
+    // 深水过渡：网格中线往南 3 行之后逐渐压向 deepwaterHeight。
+    // data 可以比网格更密（法线图），cellsPerRow 为每行对应的网格行数，过渡曲线始终按网格坐标计算
+    void ShapeDeepWater(vector<float>& data, int width, int height, float cellsPerRow) const
     {
-        vector<Vertex> vertices;
-        vector<unsigned int> indices;
-
-        int totalVertices = m_width * m_height;
-        int totalTriangles = (m_width - 1) * (m_height - 1) * 2;
-        
-        std::cout << "Generating mesh with " << totalVertices << " vertices, " 
-                  << totalTriangles << " triangles" << std::endl;
-
-        vertices.reserve(totalVertices);
-        indices.reserve(totalTriangles * 3);
-
-        // 生成顶点
-        for (int z = 0; z < m_height; z++) {
-            for (int x = 0; x < m_width; x++) {
-                Vertex vertex;
-                
-                // 位置
-                float xPos = (x - m_width / 2.0f) * m_horizontalScale;
-                float zPos = (z - m_height / 2.0f) * m_horizontalScale;
-                float yPos = heightData[z * m_width + x] * m_heightScale;
-                vertex.Position = glm::vec3(xPos, yPos, zPos);
-                
-                // 纹理坐标
-                vertex.TexCoords = glm::vec2(
-                    static_cast<float>(x) / (m_width - 1) * 10,
-                    static_cast<float>(z) / (m_height - 1) * 10
-                );
-                
-                // 初始化法线和切线
-                vertex.Normal = glm::vec3(0.0f, 1.0f, 0.0f);
-                vertex.Tangent = glm::vec3(1.0f, 0.0f, 0.0f);
-                vertex.Bitangent = glm::vec3(0.0f, 0.0f, 1.0f);
-                
-                // 初始化骨骼权重
-                for (int i = 0; i < MAX_BONE_INFLUENCE; i++) {
-                    vertex.m_BoneIDs[i] = -1;
-                    vertex.m_Weights[i] = 0.0f;
-                }
-                
-                vertices.push_back(vertex);
-            }
-        }
-
-        // 生成索引
-        for (int z = 0; z < m_height - 1; z++) {
-            for (int x = 0; x < m_width - 1; x++) {
-                int topLeft = z * m_width + x;
-                int topRight = topLeft + 1;
-                int bottomLeft = (z + 1) * m_width + x;
-                int bottomRight = bottomLeft + 1;
-
-                indices.push_back(topLeft);
-                indices.push_back(bottomLeft);
-                indices.push_back(topRight);
-
-                indices.push_back(topRight);
-                indices.push_back(bottomLeft);
-                indices.push_back(bottomRight);
+        int mid = m_height / 2;
+        int baseRow = std::clamp(static_cast<int>(std::lround((mid + 0.5f) / cellsPerRow - 0.5f)), 0, height - 1);
+        for (int z = 0; z < height; z++) {
+            float gz = z * cellsPerRow + (cellsPerRow - 1.0f) * 0.5f;
+            if (gz < mid + 3) continue;
+            float t = std::clamp((gz - m_height / 2.0f) / maxDistance, 0.0f, 1.0f);
+            t = t*t*(3-2*t); // smoothstep
+            for (int x = 0; x < width; x++) {
+                size_t idx = static_cast<size_t>(z) * width + x;
+                size_t stard_idx = static_cast<size_t>(baseRow) * width + x;
+                data[idx] = data[idx]*0.2 + data[stard_idx] + (m_deepwaterHeight - data[stard_idx]) * t * 0.8;
+                data[idx] *= 0.5f;
             }
         }
-
-        std::cout << "Calculating normals..." << std::endl;
-        CalculateNormals(vertices, indices);
-        
-        std::cout << "Calculating tangents..." << std::endl;
-        CalculateTangents(vertices, indices);
-        
-        std::cout << "Creating mesh..." << std::endl;
-        m_mesh = new Mesh(vertices, indices, m_textures);
-        
-        std::cout << "Terrain mesh created successfully!" << std::endl;
     }
 
-    void CalculateNormals(vector<Vertex>& vertices, const vector<unsigned int>& indices)
+    // 法线图取源文件分辨率（超过上限时盒式降采样），与网格同分辨率时直接用 heightData
+    void BakeNormalMap(const HeightmapFile& file, NormalMapTexels& normals) const
     {
-        for (auto& vertex : vertices) {
-            vertex.Normal = glm::vec3(0.0f);
+        int fileSize = std::max(file.GetWidth(), file.GetHeight());
+        int lod = std::max(1, (fileSize - 1 + NORMAL_MAP_RESOLUTION - 1) / NORMAL_MAP_RESOLUTION);
+        if (lod >= m_lodLevel && !m_cdlod) return;   // 不比顶点更密，没有意义
+        lod = std::min(lod, m_lodLevel);
+
+        normals.cellsPerTexel = static_cast<float>(lod) / m_lodLevel;
+        vector<float> fine;
+        const vector<float>* heights = &heightData;
+        if (lod != m_lodLevel) {
+            file.Downsample(lod, fine, normals.width, normals.height);
+            ShapeDeepWater(fine, normals.width, normals.height, normals.cellsPerTexel);
+            heights = &fine;
+        } else {
+            normals.width = m_width;
+            normals.height = m_height;
         }
+        TerrainNormalMap::Bake(*heights, normals.width, normals.height, m_heightScale,
+                               m_horizontalScale * normals.cellsPerTexel, normals.texels);
+    }
 
-        for (size_t i = 0; i < indices.size(); i += 3) {
-            unsigned int idx0 = indices[i];
-            unsigned int idx1 = indices[i + 1];
-            unsigned int idx2 = indices[i + 2];
+    void CreateNormalMap(const uint8_t* texels, int width, int height, float cellsPerTexel)
+    {
+        m_normalMap = new TerrainNormalMap(texels, width, height, heightData, m_width, m_height,
+                                           cellsPerTexel, m_heightScale, m_horizontalScale);
+        std::cout << "Terrain normal map: " << width << "x" << height
+                  << " (" << width * static_cast<size_t>(height) * 2 / (1024.0f * 1024.0f) << " MB)" << std::endl;
+    }
 
-            glm::vec3 v0 = vertices[idx0].Position;
-            glm::vec3 v1 = vertices[idx1].Position;
-            glm::vec3 v2 = vertices[idx2].Position;
+    // 缓存键：高度图内容 + 所有影响生成结果的参数，高度图不存在时为 0（不使用缓存）
+    uint64_t CacheKey(const std::string& heightmapPath) const
+    {
+        uint64_t key = ContentHash::HashFile(heightmapPath);
+        if (!key) return 0;
+        key = ContentHash::HashValue(m_heightScale, key);
+        key = ContentHash::HashValue(m_horizontalScale, key);
+        key = ContentHash::HashValue(m_lodLevel, key);
+        key = ContentHash::HashValue(m_deepwaterHeight, key);
+        key = ContentHash::HashValue(maxDistance, key);
+        key = ContentHash::HashValue(m_procedural, key);
+        key = ContentHash::HashValue(m_cdlod, key);
+        key = ContentHash::HashValue(CHUNK_QUADS, key);
+        key = ContentHash::HashValue(NORMAL_MAP_RESOLUTION, key);
+        return key;
+    }
 
-            glm::vec3 edge1 = v1 - v0;
-            glm::vec3 edge2 = v2 - v0;
-            glm::vec3 normal = glm::normalize(glm::cross(edge1, edge2));
+    bool LoadCache(const std::string& path, uint64_t key, const vector<Texture>& textures)
+    {
+        TerrainCache cache;
+        if (!cache.Open(path, key, sizeof(Vertex), sizeof(TerrainChunk), sizeof(ChunkIndexPattern)))
+            return false;
+        const TerrainCacheHeader& header = cache.GetHeader();
+        if (static_cast<size_t>(header.width) * header.height != header.heightCount)
+            return false;
+
+        m_width = header.width;
+        m_height = header.height;
+        heightData.assign(cache.GetHeights(), cache.GetHeights() + header.heightCount);
+        const TerrainChunk* chunks = static_cast<const TerrainChunk*>(cache.GetChunks());
+        m_chunks.assign(chunks, chunks + header.chunkCount);
+        const ChunkIndexPattern* patterns = static_cast<const ChunkIndexPattern*>(cache.GetPatterns());
+        m_patterns.assign(patterns, patterns + header.patternCount);
+
+        Upload(textures, static_cast<const Vertex*>(cache.GetVertices()), header.vertexCount,
+               cache.GetIndices(), header.indexCount);
+        if (header.normalWidth > 0 && header.normalHeight > 0)
+            CreateNormalMap(cache.GetNormals(), header.normalWidth, header.normalHeight, header.normalCellsPerTexel);
+        std::cout << "Loaded terrain from cache: " << path << " (" << m_width << "x" << m_height << ")" << std::endl;
+        return true;
+    }
 
-            vertices[idx0].Normal += normal;
-            vertices[idx1].Normal += normal;
-            vertices[idx2].Normal += normal;
-        }
+    void SaveCache(const std::string& path, uint64_t key, const vector<Vertex>& vertices,
+                   const vector<unsigned int>& indices, const NormalMapTexels& normals) const
+    {
+        bool ok = TerrainCache::Write(path, key, m_width, m_height, heightData,
+            vertices.data(), vertices.size(), sizeof(Vertex), indices,
+            m_chunks.data(), m_chunks.size(), sizeof(TerrainChunk),
+            m_patterns.data(), m_patterns.size(), sizeof(ChunkIndexPattern),
+            normals.texels, normals.width, normals.height, normals.cellsPerTexel);
+        if (!ok)
+            std::cout << "Failed to write terrain cache: " << path << std::endl;
+    }
 
-        for (auto& vertex : vertices) {
-            vertex.Normal = glm::normalize(vertex.Normal);
+    // 把生成好（或从缓存映射）的数据交给各模式上传到 GPU
+    void Upload(const vector<Texture>& textures, const Vertex* vertices, size_t vertexCount,
+                const unsigned int* indices, size_t indexCount)
+    {
+        if (m_cdlod)
+            GenerateCDLOD(textures);
+        else if (m_procedural)
+            GenerateProceduralGrid(textures, indices, indexCount);
+        else {
+            std::cout << "Creating mesh..." << std::endl;
+            m_mesh = new Mesh(vertices, vertexCount, indices, indexCount, textures);
+            std::cout << "Terrain mesh created successfully!" << std::endl;
         }
     }
 
-    void CalculateTangents(vector<Vertex>& vertices, const vector<unsigned int>& indices)
+    // 顶点的位置、纹理坐标和骨骼权重（法线/切线另算）
+    void FillVertex(Vertex& vertex, int x, int z) const
     {
-        for (auto& vertex : vertices) {
-            vertex.Tangent = glm::vec3(0.0f);
-            vertex.Bitangent = glm::vec3(0.0f);
+        // 位置
+        float xPos = (x - m_width / 2.0f) * m_horizontalScale;
+        float zPos = (z - m_height / 2.0f) * m_horizontalScale;
+        float yPos = heightData[z * m_width + x] * m_heightScale;
+        vertex.Position = glm::vec3(xPos, yPos, zPos);
+
+        // 纹理坐标
+        vertex.TexCoords = glm::vec2(
+            static_cast<float>(x) / (m_width - 1) * 10,
+            static_cast<float>(z) / (m_height - 1) * 10
+        );
+
+        // 初始化骨骼权重
+        for (int i = 0; i < MAX_BONE_INFLUENCE; i++) {
+            vertex.m_BoneIDs[i] = -1;
+            vertex.m_Weights[i] = 0.0f;
         }
+    }
 
-        for (size_t i = 0; i < indices.size(); i += 3) {
-            unsigned int idx0 = indices[i];
-            unsigned int idx1 = indices[i + 1];
-            unsigned int idx2 = indices[i + 2];
+    void BuildVertices(vector<Vertex>& vertices)
+    {
+        int totalVertices = m_width * m_height;
+        int totalTriangles = (m_width - 1) * (m_height - 1) * 2;
+        
+        std::cout << "Generating mesh with " << totalVertices << " vertices, " 
+                  << totalTriangles << " triangles" << std::endl;
 
-            glm::vec3 pos0 = vertices[idx0].Position;
-            glm::vec3 pos1 = vertices[idx1].Position;
-            glm::vec3 pos2 = vertices[idx2].Position;
+        vertices.resize(totalVertices);
 
-            glm::vec2 uv0 = vertices[idx0].TexCoords;
-            glm::vec2 uv1 = vertices[idx1].TexCoords;
-            glm::vec2 uv2 = vertices[idx2].TexCoords;
+        // 生成顶点：逐行并行，每个顶点只由一个线程写入
+        ParallelForRange(m_height, [&](int begin, int end) {
+            for (int z = begin; z < end; z++) {
+                for (int x = 0; x < m_width; x++)
+                    FillVertex(vertices[z * m_width + x], x, z);
+            }
+        }, 16);
+
+        // 规则网格的法线和切线直接由高度差分得到，不再遍历三角形累加
+        std::cout << "Calculating normals and tangents..." << std::endl;
+        ComputeHeightfieldFrames(heightData, m_width, m_height, m_heightScale, m_horizontalScale,
+            [&vertices](size_t i, const glm::vec3& n, const glm::vec3& t, const glm::vec3& b) {
+                vertices[i].Normal = n;
+                vertices[i].Tangent = t;
+                vertices[i].Bitangent = b;
+            });
+    }
 
-            glm::vec3 edge1 = pos1 - pos0;
-            glm::vec3 edge2 = pos2 - pos0;
-            glm::vec2 deltaUV1 = uv1 - uv0;
-            glm::vec2 deltaUV2 = uv2 - uv0;
+    // 与网格模式的拓扑相同，但不生成顶点：位置、UV、法线由顶点着色器
+    // 根据 gl_VertexID 与高度纹理计算，省去 88 字节/顶点的 Vertex 缓冲
+    void GenerateProceduralGrid(const vector<Texture>& textures, const unsigned int* indices, size_t indexCount)
+    {
+        m_textures = textures;
 
-            float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y + 0.0001f);
+        CreateHeightTexture();
 
-            glm::vec3 tangent;
-            tangent.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
-            tangent.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
-            tangent.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
+        glGenVertexArrays(1, &m_gridVAO);
+        glGenBuffers(1, &m_gridEBO);
+        glBindVertexArray(m_gridVAO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_gridEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+        glBindVertexArray(0);
 
-            glm::vec3 bitangent;
-            bitangent.x = f * (-deltaUV2.x * edge1.x + deltaUV1.x * edge2.x);
-            bitangent.y = f * (-deltaUV2.x * edge1.y + deltaUV1.x * edge2.y);
-            bitangent.z = f * (-deltaUV2.x * edge1.z + deltaUV1.x * edge2.z);
+        float indexMB = indexCount * sizeof(unsigned int) / (1024.0f * 1024.0f);
+        float savedMB = static_cast<float>(m_width) * m_height * sizeof(Vertex) / (1024.0f * 1024.0f);
+        std::cout << "Terrain uses procedural grid: " << indexMB << " MB indices, "
+                  << savedMB << " MB vertex data skipped" << std::endl;
+    }
 
-            vertices[idx0].Tangent += tangent;
-            vertices[idx1].Tangent += tangent;
-            vertices[idx2].Tangent += tangent;
+    // 地形所有无顶点属性模式共用的 R32F 高度纹理
+    void CreateHeightTexture()
+    {
+        glGenTextures(1, &m_heightTex);
+        glBindTexture(GL_TEXTURE_2D, m_heightTex);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, m_width, m_height, 0, GL_RED, GL_FLOAT, heightData.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
 
-            vertices[idx0].Bitangent += bitangent;
-            vertices[idx1].Bitangent += bitangent;
-            vertices[idx2].Bitangent += bitangent;
-        }
+    // CDLOD：高度纹理 + 一块 (PATCH_QUADS+1)^2 顶点的 patch 索引 + 四叉树
+    // 索引按象限顺序排列，四个象限连续存放即为整块 patch
+    void GenerateCDLOD(const vector<Texture>& textures)
+    {
+        m_textures = textures;
+        CreateHeightTexture();
 
-        for (auto& vertex : vertices) {
-            glm::vec3 t = vertex.Tangent;
-            glm::vec3 n = vertex.Normal;
-            
-            t = glm::normalize(t - n * glm::dot(n, t));
-            vertex.Tangent = t;
-            
-            if (glm::dot(glm::cross(n, t), vertex.Bitangent) < 0.0f) {
-                t = t * -1.0f;
+        vector<unsigned int> indices;
+        int half = PATCH_QUADS / 2;
+        int stride = PATCH_QUADS + 1;
+        for (int q = 0; q < 4; q++) {
+            int x0 = (q & 1) * half;
+            int z0 = (q >> 1) * half;
+            for (int z = z0; z < z0 + half; z++) {
+                for (int x = x0; x < x0 + half; x++) {
+                    int topLeft = z * stride + x;
+                    int topRight = topLeft + 1;
+                    int bottomLeft = (z + 1) * stride + x;
+                    int bottomRight = bottomLeft + 1;
+
+                    indices.push_back(topLeft);
+                    indices.push_back(bottomLeft);
+                    indices.push_back(topRight);
+
+                    indices.push_back(topRight);
+                    indices.push_back(bottomLeft);
+                    indices.push_back(bottomRight);
+                }
             }
-            
-            vertex.Bitangent = glm::normalize(vertex.Bitangent);
         }
+        m_patchIndexCount = static_cast<unsigned int>(indices.size());
+
+        glGenVertexArrays(1, &m_patchVAO);
+        glGenBuffers(1, &m_patchEBO);
+        glBindVertexArray(m_patchVAO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_patchEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glBindVertexArray(0);
+
+        m_quadtree = new CDLODQuadtree(heightData, m_width, m_height, m_heightScale, m_horizontalScale, PATCH_QUADS);
+    }
+
+    // gl_VertexID 包含 baseVertex，所以分块提交时顶点着色器仍能还原网格坐标
+    void SetProceduralUniforms(Shader& shader)
+    {
+        glActiveTexture(GL_TEXTURE12);
+        glBindTexture(GL_TEXTURE_2D, m_heightTex);
+        shader.setInt("heightMap", 12);
+
+        // 网格描述：(起点 x, 起点 z, 步长 x, 步长 z)，与 BuildVertices 中的顶点位置一致
+        shader.setVec4("uGridRect", glm::vec4(-m_width / 2.0f * m_horizontalScale,
+                                              -m_height / 2.0f * m_horizontalScale,
+                                              m_horizontalScale, m_horizontalScale));
+        shader.setIVec2("uGridSize", m_width, m_height);
+        shader.setFloat("uHeightScale", m_heightScale);
+        shader.setFloat("uTexRepeat", 10.0f);
+
+        glActiveTexture(GL_TEXTURE0);
     }
 };
 
@@ -13,13 +13,86 @@ uniform mat4 view;
 uniform mat4 projection;
 uniform mat4 lightSpaceMatrix;
 
+// 无顶点属性模式：由 gl_VertexID、高度纹理和网格描述生成顶点
+uniform int uProceduralGrid;
+uniform sampler2D heightMap;
+uniform vec4 uGridRect;     // (起点 x, 起点 z, 步长 x, 步长 z)
+uniform ivec2 uGridSize;    // (列数, 行数)
+uniform float uHeightScale;
+uniform float uTexRepeat;   // 漫反射纹理在整块地形上的重复次数
+
+// CDLOD 模式：同一块 patch 网格按节点矩形放置，距离越远越稀，范围末尾形变到上一级
+uniform int uCDLOD;
+uniform int uPatchQuads;    // patch 边长（四边形数）
+uniform vec4 uNodeRect;     // (起点 x, 起点 z, 节点边长, 未用)
+uniform vec2 uMorphRange;   // (开始形变的距离, 完全形变的距离)
+uniform vec3 uCameraPos;    // 阴影 pass 也传主相机位置，保证两边几何一致
+uniform vec2 uTexOrigin;    // 纹理坐标 = (xz - uTexOrigin) * uTexScale
+uniform vec2 uTexScale;
+
+float GridHeight(ivec2 cell)
+{
+    return texelFetch(heightMap, clamp(cell, ivec2(0), uGridSize - 1), 0).r * uHeightScale;
+}
+
+// 世界坐标处的双线性高度，纹素中心对应网格顶点
+float SampleHeight(vec2 xz)
+{
+    vec2 grid = (xz - uGridRect.xy) / uGridRect.zw;
+    return texture(heightMap, (grid + 0.5) / vec2(uGridSize)).r * uHeightScale;
+}
+
 void main()
 {
-    vec4 worldPos = model * vec4(aPos, 1.0);
+    vec3 pos = aPos;
+    vec3 normal = aNormal;
+    vec2 texCoords = aTexCoords;
+    if (uProceduralGrid == 1)
+    {
+        ivec2 cell = ivec2(gl_VertexID % uGridSize.x, gl_VertexID / uGridSize.x);
+        pos = vec3(uGridRect.x + float(cell.x) * uGridRect.z,
+                   GridHeight(cell),
+                   uGridRect.y + float(cell.y) * uGridRect.w);
+
+        // 中心差分求法线
+        float hL = GridHeight(cell - ivec2(1, 0));
+        float hR = GridHeight(cell + ivec2(1, 0));
+        float hD = GridHeight(cell - ivec2(0, 1));
+        float hU = GridHeight(cell + ivec2(0, 1));
+        normal = normalize(vec3((hL - hR) / (2.0 * uGridRect.z), 1.0, (hD - hU) / (2.0 * uGridRect.w)));
+
+        texCoords = vec2(cell) / vec2(uGridSize - 1) * uTexRepeat;
+    }
+    else if (uCDLOD == 1)
+    {
+        vec2 grid = vec2(gl_VertexID % (uPatchQuads + 1), gl_VertexID / (uPatchQuads + 1));
+        float quadSize = uNodeRect.z / float(uPatchQuads);
+        vec2 xz = uNodeRect.xy + grid * quadSize;
+        float dist = distance(uCameraPos, vec3(xz.x, SampleHeight(xz), xz.y));
+        float morph = clamp((dist - uMorphRange.x) / (uMorphRange.y - uMorphRange.x), 0.0, 1.0);
+
+        // 奇数顶点向相邻偶数顶点收拢，morph = 1 时与上一级网格重合，避免跳变
+        grid -= mod(grid, 2.0) * morph;
+        vec2 gridMin = uGridRect.xy;
+        vec2 gridMax = uGridRect.xy + vec2(uGridSize - 1) * uGridRect.zw;
+        xz = clamp(uNodeRect.xy + grid * quadSize, gridMin, gridMax);
+        pos = vec3(xz.x, SampleHeight(xz), xz.y);
+
+        // 法线按原始分辨率做中心差分，粗网格上也保留细节光照
+        float hL = SampleHeight(xz - vec2(uGridRect.z, 0.0));
+        float hR = SampleHeight(xz + vec2(uGridRect.z, 0.0));
+        float hD = SampleHeight(xz - vec2(0.0, uGridRect.w));
+        float hU = SampleHeight(xz + vec2(0.0, uGridRect.w));
+        normal = normalize(vec3((hL - hR) / (2.0 * uGridRect.z), 1.0, (hD - hU) / (2.0 * uGridRect.w)));
+
+        texCoords = (xz - uTexOrigin) * uTexScale;
+    }
+
+    vec4 worldPos = model * vec4(pos, 1.0);
     
     FragPos = worldPos.xyz;
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    TexCoords = aTexCoords;
+    Normal = mat3(transpose(inverse(model))) * normal;
+    TexCoords = texCoords;
     
     FragPosLightSpace = lightSpaceMatrix * worldPos;
 
@@ -0,0 +1,158 @@
+#ifndef TERRAIN_CACHE_H
+#define TERRAIN_CACHE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <mapped_file.h>
+#include <content_hash.h>
+
+// 地形二进制缓存：保存处理后的高度、可直接上传的顶点/索引流和分块信息，
+// 下次启动时内存映射后直接上传，跳过解码、海滩过渡、建网格和法线/切线计算。
+//
+// 文件布局：TerrainCacheHeader，随后依次为
+//   float heights[heightCount]
+//   <顶点结构> vertices[vertexCount]（字节数 vertexCount * vertexStride）
+//   uint32 indices[indexCount]
+//   <分块结构> chunks[chunkCount]、<索引模板结构> patterns[patternCount]
+//   uint8 normals[normalWidth * normalHeight * 2]（法线图 RG8，网格未降采样时为空）
+// 缓存键由高度图内容哈希与所有影响结果的参数组成，任一变化都会生成新文件。
+
+struct TerrainCacheHeader
+{
+    char magic[4];          // "TRC1"
+    uint32_t version;
+    uint64_t key;
+    int32_t width;
+    int32_t height;
+    uint32_t heightCount;
+    uint32_t vertexCount;
+    uint32_t vertexStride;  // sizeof(Vertex)，结构变化时缓存自动失效
+    uint32_t indexCount;
+    uint32_t chunkCount;
+    uint32_t patternCount;
+    int32_t normalWidth;
+    int32_t normalHeight;
+    float normalCellsPerTexel;  // 法线图一个纹素对应的网格格数
+};
+
+class TerrainCache
+{
+public:
+    static const uint32_t VERSION = 2;
+
+    // 缓存文件放在高度图旁边：<高度图>.<键>.tcache
+    static std::string CachePath(const std::string& heightmapPath, uint64_t key)
+    {
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+        return heightmapPath + "." + hex + ".tcache";
+    }
+
+    // 打开并校验缓存，成功后各段指针指向映射内存，在 Close 前有效
+    bool Open(const std::string& path, uint64_t key, uint32_t vertexStride, size_t chunkStride, size_t patternStride)
+    {
+        if (!m_file.Open(path) || m_file.Size() < sizeof(TerrainCacheHeader)) {
+            m_file.Close();
+            return false;
+        }
+        std::memcpy(&m_header, m_file.Data(), sizeof(m_header));
+        if (std::memcmp(m_header.magic, "TRC1", 4) != 0 || m_header.version != VERSION ||
+            m_header.key != key || m_header.vertexStride != vertexStride) {
+            m_file.Close();
+            return false;
+        }
+
+        size_t offset = sizeof(TerrainCacheHeader);
+        size_t heightsOffset = offset;   offset += m_header.heightCount * sizeof(float);
+        size_t verticesOffset = offset;  offset += static_cast<size_t>(m_header.vertexCount) * vertexStride;
+        size_t indicesOffset = offset;   offset += m_header.indexCount * sizeof(uint32_t);
+        size_t chunksOffset = offset;    offset += m_header.chunkCount * chunkStride;
+        size_t patternsOffset = offset;  offset += m_header.patternCount * patternStride;
+        size_t normalsOffset = offset;   offset += static_cast<size_t>(m_header.normalWidth) * m_header.normalHeight * 2;
+        if (m_file.Size() != offset) {
+            m_file.Close();
+            return false;
+        }
+
+        const unsigned char* base = m_file.Data();
+        m_heights = reinterpret_cast<const float*>(base + heightsOffset);
+        m_vertices = base + verticesOffset;
+        m_indices = reinterpret_cast<const uint32_t*>(base + indicesOffset);
+        m_chunks = base + chunksOffset;
+        m_patterns = base + patternsOffset;
+        m_normals = base + normalsOffset;
+        return true;
+    }
+
+    void Close() { m_file.Close(); }
+
+    const TerrainCacheHeader& GetHeader() const { return m_header; }
+    const float* GetHeights() const { return m_heights; }
+    const void* GetVertices() const { return m_vertices; }
+    const uint32_t* GetIndices() const { return m_indices; }
+    const void* GetChunks() const { return m_chunks; }
+    const void* GetPatterns() const { return m_patterns; }
+    const uint8_t* GetNormals() const { return m_normals; }
+
+    // 写到临时文件再改名，中途失败不会留下半个缓存
+    static bool Write(const std::string& path, uint64_t key, int width, int height,
+                      const std::vector<float>& heights,
+                      const void* vertices, size_t vertexCount, uint32_t vertexStride,
+                      const std::vector<unsigned int>& indices,
+                      const void* chunks, size_t chunkCount, size_t chunkStride,
+                      const void* patterns, size_t patternCount, size_t patternStride,
+                      const std::vector<uint8_t>& normals, int normalWidth, int normalHeight, float normalCellsPerTexel)
+    {
+        TerrainCacheHeader header = {};
+        std::memcpy(header.magic, "TRC1", 4);
+        header.version = VERSION;
+        header.key = key;
+        header.width = width;
+        header.height = height;
+        header.heightCount = static_cast<uint32_t>(heights.size());
+        header.vertexCount = static_cast<uint32_t>(vertexCount);
+        header.vertexStride = vertexStride;
+        header.indexCount = static_cast<uint32_t>(indices.size());
+        header.chunkCount = static_cast<uint32_t>(chunkCount);
+        header.patternCount = static_cast<uint32_t>(patternCount);
+        header.normalWidth = normalWidth;
+        header.normalHeight = normalHeight;
+        header.normalCellsPerTexel = normalCellsPerTexel;
+
+        std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary);
+            if (!out) return false;
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(heights.data()), heights.size() * sizeof(float));
+            out.write(static_cast<const char*>(vertices), vertexCount * vertexStride);
+            out.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(unsigned int));
+            out.write(static_cast<const char*>(chunks), chunkCount * chunkStride);
+            out.write(static_cast<const char*>(patterns), patternCount * patternStride);
+            out.write(reinterpret_cast<const char*>(normals.data()), normals.size());
+            if (!out) {
+                out.close();
+                std::remove(tmpPath.c_str());
+                return false;
+            }
+        }
+        std::remove(path.c_str());
+        return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+    }
+
+private:
+    MappedFile m_file;
+    TerrainCacheHeader m_header = {};
+    const float* m_heights = nullptr;
+    const void* m_vertices = nullptr;
+    const uint32_t* m_indices = nullptr;
+    const void* m_chunks = nullptr;
+    const void* m_patterns = nullptr;
+    const uint8_t* m_normals = nullptr;
+};
+
+#endif // TERRAIN_CACHE_H
@@ -0,0 +1,158 @@
+#ifndef TERRAIN_NORMAL_MAP_H
+#define TERRAIN_NORMAL_MAP_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <parallel.h>
+#include "heightfield_normals.h"
+
+// 地形法线图：网格降采样后顶点法线只剩粗糙的起伏，光照细节改由片元着色器逐像素采样这张图。
+// 法线由高分辨率高度的中心差分得到（ComputeHeightfieldFrames，按行并行），
+// 只存 xz 两个分量（RG8），y 在着色器中由单位长度还原。
+//
+// 纹素 i 的中心对应网格坐标 (i + 0.5) * cellsPerTexel - 0.5，与盒式降采样的样本中心一致。
+//
+// 局部形变：网格高度的变化量经双线性插值叠加到高分辨率高度上，所以新法线的斜率 = 原斜率 + 变化量的斜率。
+// 保留烘焙时的法线和网格高度作为基准，每次都从基准重算，量化误差不会累积。
+class TerrainNormalMap
+{
+public:
+    // heights 为法线图分辨率的归一化高度，texelSize 为一个纹素的世界尺寸，结果写入 out（每纹素 2 字节）
+    static void Bake(const std::vector<float>& heights, int width, int height,
+                     float heightScale, float texelSize, std::vector<uint8_t>& out)
+    {
+        out.resize(static_cast<size_t>(width) * height * 2);
+        ComputeHeightfieldFrames(heights, width, height, heightScale, texelSize,
+            [&out](size_t i, const glm::vec3& n, const glm::vec3&, const glm::vec3&) {
+                out[i * 2] = Encode(n.x);
+                out[i * 2 + 1] = Encode(n.z);
+            });
+    }
+
+    // texels 为 Bake 的结果（可以直接指向映射的缓存），gridHeights 为此刻的网格高度（形变基准）
+    TerrainNormalMap(const uint8_t* texels, int width, int height,
+                     const std::vector<float>& gridHeights, int gridWidth, int gridHeight,
+                     float cellsPerTexel, float heightScale, float gridSpacing)
+        : m_width(width), m_height(height), m_base(texels, texels + static_cast<size_t>(width) * height * 2),
+          m_gridBase(gridHeights), m_gridWidth(gridWidth), m_gridHeight(gridHeight),
+          m_cellsPerTexel(cellsPerTexel), m_heightScale(heightScale), m_gridSpacing(gridSpacing)
+    {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, m_width, m_height, 0, GL_RG, GL_UNSIGNED_BYTE, m_base.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    ~TerrainNormalMap()
+    {
+        if (texture) glDeleteTextures(1, &texture);
+    }
+
+    // 网格样本 [x0, x1] x [z0, z1]（闭区间）被修改后，重算双线性插值受影响的纹素并上传（只更新第 0 级）
+    void UpdateRegion(const std::vector<float>& gridHeights, int x0, int z0, int x1, int z1)
+    {
+        int tx0 = std::max(TexelFloor(x0 - 1), 0), tz0 = std::max(TexelFloor(z0 - 1), 0);
+        int tx1 = std::min(TexelCeil(x1 + 1), m_width - 1), tz1 = std::min(TexelCeil(z1 + 1), m_height - 1);
+        if (tx0 > tx1 || tz0 > tz1) return;
+        int w = tx1 - tx0 + 1;
+        m_update.resize(static_cast<size_t>(w) * (tz1 - tz0 + 1) * 2);
+        float slopeScale = m_heightScale / m_gridSpacing;
+
+        ParallelForRange(tz1 - tz0 + 1, [&](int begin, int end) {
+            for (int tz = tz0 + begin; tz < tz0 + end; tz++) {
+                float gz = glm::clamp((tz + 0.5f) * m_cellsPerTexel - 0.5f, 0.0f, m_gridHeight - 1.0f);
+                int cz = std::min(static_cast<int>(gz), std::max(m_gridHeight - 2, 0));
+                int cz1 = std::min(cz + 1, m_gridHeight - 1);
+                float fz = gz - cz;
+
+                for (int tx = tx0; tx <= tx1; tx++) {
+                    float gx = glm::clamp((tx + 0.5f) * m_cellsPerTexel - 0.5f, 0.0f, m_gridWidth - 1.0f);
+                    int cx = std::min(static_cast<int>(gx), std::max(m_gridWidth - 2, 0));
+                    int cx1 = std::min(cx + 1, m_gridWidth - 1);
+                    float fx = gx - cx;
+
+                    float d00 = Delta(gridHeights, cx, cz), d10 = Delta(gridHeights, cx1, cz);
+                    float d01 = Delta(gridHeights, cx, cz1), d11 = Delta(gridHeights, cx1, cz1);
+                    float ddx = glm::mix(d10 - d00, d11 - d01, fz) * slopeScale;
+                    float ddz = glm::mix(d01 - d00, d11 - d10, fx) * slopeScale;
+
+                    // 基准法线还原为斜率，叠加变化量的斜率后重新编码
+                    const uint8_t* base = &m_base[(static_cast<size_t>(tz) * m_width + tx) * 2];
+                    float nx = Decode(base[0]), nz = Decode(base[1]);
+                    float ny = std::sqrt(std::max(1.0f - nx * nx - nz * nz, 1e-6f));
+                    glm::vec3 n = glm::normalize(glm::vec3(nx / ny - ddx, 1.0f, nz / ny - ddz));
+
+                    uint8_t* dst = &m_update[(static_cast<size_t>(tz - tz0) * w + (tx - tx0)) * 2];
+                    dst[0] = Encode(n.x);
+                    dst[1] = Encode(n.z);
+                }
+            }
+        }, 16);
+
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, tx0, tz0, w, tz1 - tz0 + 1, GL_RG, GL_UNSIGNED_BYTE, m_update.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        m_mipsDirty = true;
+    }
+
+    // 重新生成 mipmap：代价与整张图成正比，连续形变期间不调用，停手后由 Terrain 统一补一次
+    void UpdateMips()
+    {
+        if (!m_mipsDirty) return;
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        m_mipsDirty = false;
+    }
+
+    unsigned int GetTexture() const { return texture; }
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+
+    // 世界 xz 到纹理坐标：uv = (xz - rect.xy) * rect.zw，坐标约定与 Terrain 相同
+    glm::vec4 GetRect() const
+    {
+        return glm::vec4(-(0.5f + m_gridWidth / 2.0f) * m_gridSpacing,
+                         -(0.5f + m_gridHeight / 2.0f) * m_gridSpacing,
+                         1.0f / (m_width * m_cellsPerTexel * m_gridSpacing),
+                         1.0f / (m_height * m_cellsPerTexel * m_gridSpacing));
+    }
+
+private:
+    int m_width, m_height;
+    std::vector<uint8_t> m_base;     // 烘焙时的法线
+    std::vector<uint8_t> m_update;   // 局部上传的临时缓冲，跨帧复用
+    std::vector<float> m_gridBase;   // 烘焙时的网格高度
+    int m_gridWidth, m_gridHeight;
+    float m_cellsPerTexel;
+    float m_heightScale;
+    float m_gridSpacing;
+    unsigned int texture = 0;
+    bool m_mipsDirty = false;        // 第 0 级已更新、mipmap 尚未重建
+
+    // 128 对应 0，水平面法线编码后不偏
+    static uint8_t Encode(float v) { return static_cast<uint8_t>(glm::clamp(std::round(v * 127.0f) + 128.0f, 1.0f, 255.0f)); }
+    static float Decode(uint8_t v) { return (v - 128.0f) / 127.0f; }
+
+    float Delta(const std::vector<float>& gridHeights, int x, int z) const
+    {
+        size_t i = static_cast<size_t>(z) * m_gridWidth + x;
+        return gridHeights[i] - m_gridBase[i];
+    }
+
+    // 网格坐标到纹素索引（向外取整）
+    int TexelFloor(int g) const { return static_cast<int>(std::floor((g + 0.5f) / m_cellsPerTexel - 0.5f)); }
+    int TexelCeil(int g) const { return static_cast<int>(std::ceil((g + 0.5f) / m_cellsPerTexel - 0.5f)); }
+};
+
+#endif // TERRAIN_NORMAL_MAP_H
@@ -36,34 +36,249 @@ uniform int isAbove;
 
 uniform float shininess;
 
+// 反射/折射纹理中实际渲染区域所占比例（动态分辨率，1 表示全分辨率）
+// 屏幕空间折射时折射纹理是全分辨率的场景拷贝，两者比例可能不同
+uniform vec2 reflectionScale;
+uniform vec2 refractionScale;
+
+// 层级深度屏幕空间反射 (Hi-Z SSR)
+uniform mat4 view;
+uniform mat4 projection;
+uniform int ssrEnabled;
+uniform sampler2D sceneColorTexture;  // 不透明部分的屏幕颜色
+uniform sampler2D hizTexture;         // 每级保存 2x2 区域的最小深度
+uniform samplerCube skyboxTexture;
+uniform int hizMaxLevel;
+uniform int ssrMaxSteps;
+uniform float ssrThickness;
+uniform float dayFactor;
+
+// 分帧更新：反射/折射纹理是之前某帧渲染的，用当时的 view-projection 矩阵重投影
+uniform int reprojectReflection;
+uniform int reprojectRefraction;
+uniform mat4 historyViewProj;
+
+// 海岸线距离场 (R: 到岸有向距离, G: 水深)，有它时不再依赖深度缓冲重建水深
+uniform int useShoreline;
+uniform sampler2D shorelineTexture;
+uniform vec4 shoreRect;
+
+// 从深度纹理重建视空间深度，近/远平面直接取自投影矩阵
+float LinearizeDepth(float depthValue)
+{
+    return projection[3][2] / ((2.0 * depthValue - 1.0) + projection[2][2]);
+}
+
+// 把 [0,1] 屏幕坐标映射到低分辨率渲染区域内，并夹在半个纹素以内防止越界采样
+vec2 ToViewportUV(vec2 uv, sampler2D tex, vec2 scale)
+{
+    vec2 halfTexel = 0.5 / vec2(textureSize(tex, 0));
+    return clamp(uv * scale, halfTexel, scale - halfTexel);
+}
+
+// 深度感知的双边上采样：在 2x2 个低分辨率纹素间按双线性权重混合，
+// 再按与参考纹素的深度差降低权重，避免前后景颜色在边缘互相渗透
+vec4 SampleRefractionBilateral(vec2 uv, float waterDepth)
+{
+    vec2 texSize = vec2(textureSize(refractionTexture, 0));
+    ivec2 maxTexel = max(ivec2(texSize * refractionScale) - 1, ivec2(0));
+    vec2 pos = clamp(uv, 0.0, 1.0) * refractionScale * texSize - 0.5;
+    ivec2 base = ivec2(floor(pos));
+    vec2 f = fract(pos);
+
+    // 双线性权重最大的纹素作为参考深度
+    ivec2 nearest = clamp(base + ivec2(round(f)), ivec2(0), maxTexel);
+    float refDepth = LinearizeDepth(texelFetch(depthTexture, nearest, 0).r);
+
+    vec4 sum = vec4(0.0);
+    float weightSum = 0.0;
+    for (int j = 0; j < 2; j++)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            ivec2 p = clamp(base + ivec2(i, j), ivec2(0), maxTexel);
+            float bilinear = (i == 0 ? 1.0 - f.x : f.x) * (j == 0 ? 1.0 - f.y : f.y);
+            float d = LinearizeDepth(texelFetch(depthTexture, p, 0).r);
+            float depthWeight = 1.0 / (1.0 + abs(d - refDepth));
+            // 比水面更近的纹素属于水面上方的物体，不应出现在折射中
+            if (d < waterDepth)
+                depthWeight *= 0.1;
+            float w = bilinear * depthWeight + 1e-4;
+            sum += texelFetch(refractionTexture, p, 0) * w;
+            weightSum += w;
+        }
+    }
+    return sum / weightSum;
+}
+
+// 视空间坐标投影到 [0,1]^3 屏幕空间（xy 为纹理坐标，z 为窗口深度）
+vec3 ProjectToScreen(vec3 viewSpacePos)
+{
+    vec4 clip = projection * vec4(viewSpacePos, 1.0);
+    return clip.xyz / clip.w * 0.5 + 0.5;
+}
+
+// 从 start 出发沿 dir 走，返回离开 cell 所在单元时的参数 t（略微越过边界）
+float CellExitT(vec3 start, vec3 dir, vec2 cell, vec2 cellCount, vec2 crossStep)
+{
+    vec2 boundary = (cell + crossStep) / cellCount + (crossStep * 2.0 - 1.0) * (0.001 / cellCount);
+    vec2 t = vec2(1e6);
+    if (abs(dir.x) > 1e-6) t.x = (boundary.x - start.x) / dir.x;
+    if (abs(dir.y) > 1e-6) t.y = (boundary.y - start.y) / dir.y;
+    return min(t.x, t.y);
+}
+
+// Hi-Z 步进：整个单元都在最近深度之前就跳过并升一级，可能相交就降一级细查
+bool HiZTrace(vec3 start, vec3 dir, float tMax, out vec3 hit)
+{
+    hit = start;
+    vec2 crossStep = vec2(dir.x >= 0.0 ? 1.0 : 0.0, dir.y >= 0.0 ? 1.0 : 0.0);
+
+    // 先走出起始像素，避免与自身相交
+    vec2 baseCount = vec2(textureSize(hizTexture, 0));
+    float t = CellExitT(start, dir, floor(start.xy * baseCount), baseCount, crossStep);
+    int level = 0;
+
+    for (int i = 0; i < ssrMaxSteps && t < tMax; i++)
+    {
+        vec2 cellCount = vec2(textureSize(hizTexture, level));
+        vec3 pos = start + dir * t;
+        vec2 cell = floor(pos.xy * cellCount);
+        float tExit = CellExitT(start, dir, cell, cellCount, crossStep);
+        float zMin = texelFetch(hizTexture, ivec2(cell), level).r;
+        float zExit = start.z + dir.z * min(tExit, tMax);
+
+        if (max(pos.z, zExit) < zMin)
+        {
+            t = tExit;
+            level = min(level + 1, hizMaxLevel);
+            continue;
+        }
+
+        // 向远处走的光线可以直接推进到最近深度所在位置
+        float tHit = t;
+        if (dir.z > 0.0 && pos.z < zMin)
+            tHit = (zMin - start.z) / dir.z;
+
+        if (level > 0)
+        {
+            t = tHit;
+            level--;
+            continue;
+        }
+
+        vec3 p = start + dir * tHit;
+        if (LinearizeDepth(p.z) - LinearizeDepth(zMin) < ssrThickness)
+        {
+            hit = p;
+            return true;
+        }
+        // 从薄物体背后穿过，继续往前找
+        t = tExit;
+    }
+    return false;
+}
+
+vec3 SampleSky(vec3 dir)
+{
+    // 与天空盒着色器相同的 gamma 处理，亮度随昼夜变化
+    vec3 color = pow(texture(skyboxTexture, dir).rgb, vec3(1.0 / 2.2));
+    color *= mix(0.3, 1.0, clamp(dayFactor, 0.0, 1.0));
+    return pow(color, vec3(2.2));
+}
+
+vec3 TraceScreenSpaceReflection(vec3 worldPos, vec3 worldDir)
+{
+    vec3 skyColor = SampleSky(worldDir);
+
+    vec3 vsPos = (view * vec4(worldPos, 1.0)).xyz;
+    vec3 vsDir = normalize(mat3(view) * worldDir);
+
+    // 朝向相机的光线要停在近平面之前
+    float near = projection[3][2] / (projection[2][2] - 1.0);
+    float rayLength = 1000.0;
+    if (vsDir.z > 0.0)
+        rayLength = min(rayLength, (-near - vsPos.z) / vsDir.z * 0.99);
+    if (rayLength <= 0.0)
+        return skyColor;
+
+    vec3 start = ProjectToScreen(vsPos);
+    vec3 dir = ProjectToScreen(vsPos + vsDir * rayLength) - start;
+
+    // 把光线截断在屏幕范围内
+    float tMax = 1.0;
+    if (dir.x > 0.0) tMax = min(tMax, (1.0 - start.x) / dir.x);
+    else if (dir.x < 0.0) tMax = min(tMax, -start.x / dir.x);
+    if (dir.y > 0.0) tMax = min(tMax, (1.0 - start.y) / dir.y);
+    else if (dir.y < 0.0) tMax = min(tMax, -start.y / dir.y);
+
+    vec3 hit;
+    if (!HiZTrace(start, dir, tMax, hit))
+        return skyColor;
+
+    // 命中点靠近屏幕边缘时渐变到天空盒，避免反射突然被截断
+    vec2 edge = smoothstep(0.0, 0.08, hit.xy) * (1.0 - smoothstep(0.92, 1.0, hit.xy));
+    vec3 sceneColor = texture(sceneColorTexture, hit.xy).rgb;
+    return mix(skyColor, sceneColor, edge.x * edge.y);
+}
+
 void main()
 {
     vec3 norm = normalize(Normal);
 
     vec2 ndc = glp.xy / glp.w;
-    vec2 refractTexCoords = ndc * 0.5 + 0.5 + norm.xz * 0.1;
-    vec2 reflectTexCoords = vec2(refractTexCoords.x, 1.0 - refractTexCoords.y);
+    vec2 screenTexCoords = ndc * 0.5 + 0.5;
+
+    // 同一水面点在旧纹理渲染时所在的屏幕位置和深度
+    vec4 historyClip = historyViewProj * vec4(FragPos, 1.0);
+    vec3 historyScreen = historyClip.xyz / historyClip.w * 0.5 + 0.5;
+    vec2 refractBase = (reprojectRefraction == 1) ? historyScreen.xy : screenTexCoords;
+    vec2 reflectBase = (reprojectReflection == 1) ? historyScreen.xy : screenTexCoords;
+
+    vec2 refractTexCoords = refractBase + norm.xz * 0.1;
+    vec2 reflectTexCoords = reflectBase + norm.xz * 0.1;
+    reflectTexCoords.y = 1.0 - reflectTexCoords.y;
     
     refractTexCoords = clamp(refractTexCoords, 0.001, 0.999);
     reflectTexCoords = clamp(reflectTexCoords, 0.001, 0.999);
+
+    // 水面深度(当前片段的深度)，与折射深度纹理比较时要用纹理渲染时的深度
+    float waterDepth = LinearizeDepth((reprojectRefraction == 1) ? historyScreen.z : gl_FragCoord.z);
+
+    // 扰动后的坐标落在水面前方的物体上时，退回不扰动的坐标，
+    // 否则屏幕空间折射会把水面上方的物体"折射"进水里
+    float distortedDepth = LinearizeDepth(texture(depthTexture, ToViewportUV(refractTexCoords, depthTexture, refractionScale)).r);
+    if (distortedDepth < waterDepth)
+        refractTexCoords = clamp(refractBase, 0.001, 0.999);
     
-    vec4 refractColor = texture(refractionTexture, refractTexCoords);
-    vec4 reflectColor = texture(reflectionTexture, reflectTexCoords);
-
-    float depthValue = texture(depthTexture, refractTexCoords).r;
-    // 从深度纹理重建视空间深度
-    float near = 0.1;   // 需要与你的相机近平面一致
-    float far = 1000.0; // 需要与你的相机远平面一致
-    // 地面深度(折射纹理对应的深度)
-    float floorDepth = (2.0 * near * far) / (far + near - (2.0 * depthValue - 1.0) * (far - near));
-    // 水面深度(当前片段的深度)
-    float waterDepth = (2.0 * near * far) / (far + near - (2.0 * gl_FragCoord.z - 1.0) * (far - near));
-    // 水的深度差
-    float depth = floorDepth - waterDepth;
+    vec4 refractColor = SampleRefractionBilateral(refractTexCoords, waterDepth);
+    // 反射只包含天空盒，没有深度边缘，直接双线性放大即可
+    vec4 reflectColor = texture(reflectionTexture, ToViewportUV(reflectTexCoords, reflectionTexture, reflectionScale));
+
+    vec3 viewDir = normalize(viewPos - FragPos);
+    if (ssrEnabled == 1 && isAbove == 1)
+        reflectColor = vec4(TraceScreenSpaceReflection(FragPos, reflect(-viewDir, norm)), 1.0);
+
+    float depth;
+    float shoreDistance = 1000.0;
+    if (useShoreline == 1)
+    {
+        vec2 shore = texture(shorelineTexture, (FragPos.xz - shoreRect.xy) * shoreRect.zw).rg;
+        shoreDistance = shore.r;
+        // 垂直水深换算成视线在水中穿过的长度，掠射角时更长
+        depth = max(shore.g, 0.0) / max(viewDir.y, 0.2);
+    }
+    else
+    {
+        float depthValue = texture(depthTexture, ToViewportUV(refractTexCoords, depthTexture, refractionScale)).r;
+        // 地面深度(折射纹理对应的深度)
+        float floorDepth = LinearizeDepth(depthValue);
+        // 水的深度差
+        depth = floorDepth - waterDepth;
+    }
     depth = clamp(depth, 0.0, 50.0); // 限制最大深度
 
     // 计算光照
-    vec3 viewDir = normalize(viewPos - FragPos);
     
     // 方向光
     vec3 lightDir = normalize(-dirLight.direction);
@@ -108,6 +323,19 @@ void main()
         // 7. 最终颜色混合
         vec3 finalColor = mix(refraction, reflection, fresnel * 0.6);
         finalColor = mix(finalColor, litWaterColor, 0.3);
+
+        if (useShoreline == 1)
+        {
+            // 9. 岸边泡沫：离岸越近越多，条纹随时间向岸边推进
+            float foamBand = 1.0 - smoothstep(0.0, 6.0, shoreDistance);
+            float foamWave = smoothstep(0.6, 1.0, 0.5 + 0.5 * sin(shoreDistance * 1.2 + time * 2.0));
+            float foam = foamBand * max(foamWave, 1.0 - smoothstep(0.0, 1.0, shoreDistance));
+            finalColor = mix(finalColor, vec3(0.95) * (ambient + diffuse + 0.3), foam * 0.8);
+
+            // 水边线附近淡出，避免与沙滩相交处出现硬边
+            waterAlpha *= smoothstep(-0.5, 0.5, shoreDistance);
+            waterAlpha = max(waterAlpha, foam * 0.9 * step(0.0, shoreDistance));
+        }
         
         // 8. 输出带透明度的颜色
         FragColor = vec4(finalColor, waterAlpha);
@@ -15,19 +15,51 @@ uniform float uTime;  // [0, 1] 循环时间
 uniform sampler3D displacementMap;
 uniform sampler3D normalMap;
 
+// 无顶点属性模式：由 gl_VertexID 和网格描述生成顶点
+uniform int uProceduralGrid;
+uniform vec4 uGridRect;     // (起点 x, 起点 z, x 步长, z 步长)
+uniform ivec2 uGridSize;    // (列数, 行数)
+uniform float uGridHeight;  // 水面高度
+
+// 海岸线距离场：靠岸处减弱波浪
+uniform int useShoreline;
+uniform sampler2D shorelineTexture;
+uniform vec4 shoreRect;          // uv = (xz - rect.xy) * rect.zw
+uniform float shoreDampDistance; // 距岸多远开始衰减
+
 void main()
 {
+    vec3 basePos = aPos;
+    vec2 texCoord = aTexCoord;
+    if (uProceduralGrid == 1)
+    {
+        ivec2 cell = ivec2(gl_VertexID % uGridSize.x, gl_VertexID / uGridSize.x);
+        basePos = vec3(uGridRect.x + float(cell.x) * uGridRect.z,
+                       uGridHeight,
+                       uGridRect.y + float(cell.y) * uGridRect.w);
+        texCoord = vec2(cell) / vec2(uGridSize - 1);
+    }
+
     // 从 3D 纹理采样位移和法线
-    vec3 uvw = vec3(aTexCoord, uTime);
+    vec3 uvw = vec3(texCoord, uTime);
     vec3 displacement = texture(displacementMap, uvw).xyz;
     vec3 normal = texture(normalMap, uvw).xyz;
+
+    if (useShoreline == 1)
+    {
+        vec2 shoreUV = ((model * vec4(basePos, 1.0)).xz - shoreRect.xy) * shoreRect.zw;
+        float shoreDistance = texture(shorelineTexture, shoreUV).r;
+        float damping = mix(0.15, 1.0, smoothstep(0.0, shoreDampDistance, shoreDistance));
+        displacement *= damping;
+        normal = mix(vec3(0.0, 1.0, 0.0), normal, damping);
+    }
     
     // 应用位移
-    vec3 displacedPos = aPos + displacement;
+    vec3 displacedPos = basePos + displacement;
     
     FragPos = vec3(model * vec4(displacedPos, 1.0));
     Normal = mat3(transpose(inverse(model))) * normal;
-    TexCoords = aTexCoord;
+    TexCoords = texCoord;
     glp = projection * view * vec4(FragPos, 1.0);
     
     gl_Position = projection * view * vec4(FragPos, 1.0);
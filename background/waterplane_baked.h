@@ -4,7 +4,17 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <shader.h>
+#include <frustum.h>
 #include <vector>
+#include <algorithm>
+
+// 水面分块：每块在索引缓冲中占一段连续区间，并带有按最大位移膨胀过的包围盒
+struct OceanTile {
+    glm::vec3 aabbMin;
+    glm::vec3 aabbMax;
+    unsigned int indexOffset;  // 在 EBO 中的起始索引
+    unsigned int indexCount;
+};
 
 class OceanBaked
 {
@@ -18,12 +28,25 @@ private:
     unsigned int displacementTex;
     unsigned int normalTex;
     float timeSpan;
+    glm::vec3 maxDisplacement;  // 烘焙得到的最大位移，用于膨胀包围盒
+
+    int tileQuads;                      // 每块每边的四边形数量
+    std::vector<OceanTile> tiles;
+    std::vector<GLsizei> drawCounts;    // 每帧可见块的绘制参数
+    std::vector<const void*> drawOffsets;
+    int visibleTiles = 0;
+
+    // 无顶点属性模式：不上传 VBO，顶点着色器由 gl_VertexID 和网格描述生成位置与 UV
+    bool proceduralGrid;
 
 public:
     OceanBaked(int N, float Lx, float Lz, float waterHeight,
-               unsigned int displacementTex, unsigned int normalTex, float timeSpan)
+               unsigned int displacementTex, unsigned int normalTex, float timeSpan,
+               glm::vec3 maxDisplacement = glm::vec3(0.0f), int tileQuads = 16,
+               bool proceduralGrid = false)
         : N(N), Lx(Lx), Lz(Lz), waterHeight(waterHeight),
-          displacementTex(displacementTex), normalTex(normalTex), timeSpan(timeSpan)
+          displacementTex(displacementTex), normalTex(normalTex), timeSpan(timeSpan),
+          maxDisplacement(maxDisplacement), tileQuads(tileQuads), proceduralGrid(proceduralGrid)
     {
         SetupMesh();
     }
@@ -31,7 +54,7 @@ public:
     ~OceanBaked()
     {
         glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
+        if (VBO) glDeleteBuffers(1, &VBO);
         glDeleteBuffers(1, &EBO);
     }
     
@@ -59,30 +82,66 @@ public:
             }
         }
         
-        // 生成索引
-        for (int m = 0; m < N - 1; m++) {
-            for (int n = 0; n < N - 1; n++) {
-                int i0 = m * N + n;
-                int i1 = m * N + n + 1;
-                int i2 = (m + 1) * N + n;
-                int i3 = (m + 1) * N + n + 1;
-                
-                indices.push_back(i0);
-                indices.push_back(i2);
-                indices.push_back(i1);
-                
-                indices.push_back(i1);
-                indices.push_back(i2);
-                indices.push_back(i3);
+        // 按块生成索引：同一块的三角形在 EBO 中连续存放，便于只提交可见块
+        int quads = N - 1;
+        int tilesPerSide = (quads + tileQuads - 1) / tileQuads;
+        for (int tz = 0; tz < tilesPerSide; tz++) {
+            for (int tx = 0; tx < tilesPerSide; tx++) {
+                int m0 = tz * tileQuads, m1 = std::min(m0 + tileQuads, quads);
+                int n0 = tx * tileQuads, n1 = std::min(n0 + tileQuads, quads);
+
+                OceanTile tile;
+                tile.indexOffset = static_cast<unsigned int>(indices.size());
+
+                for (int m = m0; m < m1; m++) {
+                    for (int n = n0; n < n1; n++) {
+                        int i0 = m * N + n;
+                        int i1 = m * N + n + 1;
+                        int i2 = (m + 1) * N + n;
+                        int i3 = (m + 1) * N + n + 1;
+                        
+                        indices.push_back(i0);
+                        indices.push_back(i2);
+                        indices.push_back(i1);
+                        
+                        indices.push_back(i1);
+                        indices.push_back(i2);
+                        indices.push_back(i3);
+                    }
+                }
+                tile.indexCount = static_cast<unsigned int>(indices.size()) - tile.indexOffset;
+
+                // 未位移的块范围，再按最大位移向各方向膨胀
+                glm::vec3 lo = positions[m0 * N + n0];
+                glm::vec3 hi = positions[m1 * N + n1];
+                tile.aabbMin = glm::min(lo, hi) - maxDisplacement;
+                tile.aabbMax = glm::max(lo, hi) + maxDisplacement;
+                tiles.push_back(tile);
             }
         }
+        drawCounts.reserve(tiles.size());
+        drawOffsets.reserve(tiles.size());
+        std::cout << "Ocean split into " << tiles.size() << " tiles ("
+                  << tilesPerSide << "x" << tilesPerSide << ")" << std::endl;
         
         glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
         glGenBuffers(1, &EBO);
         
         glBindVertexArray(VAO);
         
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, 
+                     indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        
+        if (proceduralGrid) {
+            // 只保留索引缓冲，gl_VertexID 即网格顶点编号
+            VBO = 0;
+            glBindVertexArray(0);
+            std::cout << "Ocean uses procedural grid (no vertex buffers)" << std::endl;
+            return;
+        }
+        
+        glGenBuffers(1, &VBO);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, 
                      (positions.size() * sizeof(glm::vec3) + texCoords.size() * sizeof(glm::vec2)), 
@@ -92,10 +151,6 @@ public:
         glBufferSubData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3),
                        texCoords.size() * sizeof(glm::vec2), texCoords.data());
         
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, 
-                     indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-        
         // 位置
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
         glEnableVertexAttribArray(0);
@@ -108,7 +163,8 @@ public:
         glBindVertexArray(0);
     }
     
-    void Draw(Shader& shader, float time)
+    // viewProj 用于视锥剔除，只提交与视锥相交的块
+    void Draw(Shader& shader, float time, const glm::mat4& viewProj)
     {
         shader.use();
         
@@ -125,12 +181,37 @@ public:
         glBindTexture(GL_TEXTURE_3D, normalTex);
         shader.setInt("normalMap", 11);
         
+        // 网格描述：(起点 x, 起点 z, x 步长, z 步长)，与 SetupMesh 中的顶点布局一致
+        shader.setInt("uProceduralGrid", proceduralGrid ? 1 : 0);
+        if (proceduralGrid) {
+            shader.setVec4("uGridRect", glm::vec4(-Lx, 0.0f, 2.0f * Lx / (N - 1), Lz / (N - 1)));
+            shader.setIVec2("uGridSize", N, N);
+            shader.setFloat("uGridHeight", waterHeight);
+        }
+        
+        Frustum frustum(viewProj);
+        drawCounts.clear();
+        drawOffsets.clear();
+        for (const OceanTile& tile : tiles) {
+            if (!frustum.IntersectsAABB(tile.aabbMin, tile.aabbMax)) continue;
+            drawCounts.push_back(static_cast<GLsizei>(tile.indexCount));
+            drawOffsets.push_back((const void*)(tile.indexOffset * sizeof(unsigned int)));
+        }
+        visibleTiles = static_cast<int>(drawCounts.size());
+        if (visibleTiles == 0) return;
+        
         glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+        glMultiDrawElements(GL_TRIANGLES, drawCounts.data(), GL_UNSIGNED_INT,
+                            drawOffsets.data(), visibleTiles);
         glBindVertexArray(0);
     }
     
     float GetHeight() const { return waterHeight; }
+    float GetTimeSpan() const { return timeSpan; }
+    // 世界坐标 xz 到海面纹理坐标：uv = (xz - rect.xy) * rect.zw，与 water.vs 中的纹理坐标一致
+    glm::vec4 GetTexCoordRect() const { return glm::vec4(-Lx, 0.0f, 1.0f / (2.0f * Lx), 1.0f / Lz); }
+    int GetTileCount() const { return static_cast<int>(tiles.size()); }
+    int GetVisibleTileCount() const { return visibleTiles; }
 };
 
 #endif // OCEAN_BAKED_H
\ No newline at end of file
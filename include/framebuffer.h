@@ -6,8 +6,9 @@
 
 class Framebuffer {
 public:
-    Framebuffer(int width, int height, bool withDepth = true)
-        : m_width(width), m_height(height), m_withDepth(withDepth)
+    // depthStencil: 深度纹理使用 D24S8 格式，与默认帧缓冲一致，才能用 glBlitFramebuffer 拷贝深度
+    Framebuffer(int width, int height, bool withDepth = true, bool depthStencil = false)
+        : m_width(width), m_height(height), m_withDepth(withDepth), m_depthStencil(depthStencil)
     {
         CreateFramebuffer();
     }
@@ -21,16 +22,38 @@ public:
         glViewport(0, 0, m_width, m_height);
     }
 
+    // 只使用左下角 scale 比例的区域渲染（动态分辨率），纹理本身不重新分配
+    void Bind(float scale) const {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        glViewport(0, 0, GetScaledSize(m_width, scale), GetScaledSize(m_height, scale));
+    }
+
     void Unbind(int screenWidth, int screenHeight) const {
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         glViewport(0, 0, screenWidth, screenHeight);
     }
 
+    // 把默认帧缓冲（屏幕）的颜色和深度拷贝到本缓冲，尺寸需与屏幕一致
+    void CopyFromDefault(int screenWidth, int screenHeight) const {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_fbo);
+        GLbitfield mask = GL_COLOR_BUFFER_BIT;
+        if (m_withDepth && m_depthStencil)
+            mask |= GL_DEPTH_BUFFER_BIT;
+        glBlitFramebuffer(0, 0, screenWidth, screenHeight, 0, 0, m_width, m_height, mask, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
     unsigned int GetTexture() const { return m_texture; }
     unsigned int GetDepthTexture() const { return m_depthTexture; }
     float GetWidth() const { return m_width; }
     float GetHeight() const { return m_height; }
 
+    static int GetScaledSize(int size, float scale) {
+        int scaled = static_cast<int>(size * scale + 0.5f);
+        return scaled < 1 ? 1 : scaled;
+    }
+
     void Resize(int width, int height) {
         if (width == m_width && height == m_height) return;
         
@@ -47,6 +70,7 @@ private:
     unsigned int m_rbo = 0;
     int m_width, m_height;
     bool m_withDepth;
+    bool m_depthStencil;
 
     void CreateFramebuffer() {
         // 创建帧缓冲
@@ -63,7 +87,18 @@ private:
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, 0);
 
-        if (m_withDepth) {
+        if (m_withDepth && m_depthStencil) {
+            // 创建深度模板纹理
+            glGenTextures(1, &m_depthTexture);
+            glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, m_width, m_height, 0,
+                        GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+        } else if (m_withDepth) {
             // 创建深度纹理
             glGenTextures(1, &m_depthTexture);
             glBindTexture(GL_TEXTURE_2D, m_depthTexture);
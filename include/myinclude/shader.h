@@ -101,6 +101,10 @@ public:
     {
         glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
     }
+    void setIVec2(const std::string& name, int x, int y) const
+    {
+        glUniform2i(glGetUniformLocation(ID, name.c_str()), x, y);
+    }
     // ------------------------------------------------------------------------
     void setVec3(const std::string& name, const glm::vec3& value) const
     {
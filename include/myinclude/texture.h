@@ -10,6 +10,10 @@
 #include <iostream>
 #include <glad/glad.h>
 #include <myinclude/mesh.h>
+#include <mapped_file.h>
+#include <texture_cache.h>
+#include <image_decode.h>
+#include <memory>
 
 using namespace std;
 
@@ -28,7 +32,7 @@ public:
 	Texture LoadTexture(std::string texture_path, std::string type)
 	{
 		unsigned int textureID;
-		textureID = LoadFromFile(texture_path);
+		textureID = LoadFromFiles(vector<string>{ texture_path })[0];
 
 		return Texture{
 			textureID,type,texture_path
@@ -37,12 +41,13 @@ public:
 	vector<Texture> LoadTexture(vector<string> texture_paths, vector<string> types)
 	{
 		assert(texture_paths.size() == types.size());
+		vector<unsigned int> ids = LoadFromFiles(texture_paths);
 		vector<Texture> textures;
 		for (int i = 0; i < texture_paths.size(); i++)
 		{
 			textures.push_back(
 				Texture{
-					LoadFromFile(texture_paths[i]),types[i],texture_paths[i]
+					ids[i],types[i],texture_paths[i]
 				}
 			);
 		}
@@ -50,40 +55,57 @@ public:
 
 	}
 private:
-	unsigned int LoadFromFile(std::string texture_path)
+	// 同一内容、同一采样参数的图片在进程内只上传一次（TextureCache）；
+	// 未命中的图片由多个线程同时解码（ImageDecodeBatch），GL 线程只负责上传
+	vector<unsigned int> LoadFromFiles(const vector<string>& texture_paths)
 	{
-		unsigned int textureID;
-		glGenTextures(1, &textureID);
+		TextureCache::Sampler sampler = { GL_TEXTURE_2D, warp_s, warp_t, min_filter, mag_filter };
+		size_t count = texture_paths.size();
+		vector<unsigned int> ids(count, 0);
+		vector<uint64_t> keys(count, 0);
+		vector<int> slots(count, -1);
+		vector<unique_ptr<MappedFile>> files;
+		ImageDecodeBatch batch;
 
-		int width, height, nrComponents;
-		unsigned char *data = stbi_load(texture_path.c_str(), &width, &height, &nrComponents, 0);
-		if (data)
+		for (size_t i = 0; i < count; i++)
 		{
-			GLenum format;
-			if (nrComponents == 1)
-				format = GL_RED;
-			else if (nrComponents == 3)
-				format = GL_RGB;
-			else if (nrComponents == 4)
-				format = GL_RGBA;
+			files.emplace_back(new MappedFile());
+			if (!files[i]->Open(texture_paths[i]))
+				continue;
+			keys[i] = TextureCache::Key(files[i]->Data(), files[i]->Size(), sampler);
+			ids[i] = TextureCache::Instance().Acquire(keys[i]);
+			if (ids[i] == 0)
+				slots[i] = batch.Add(texture_paths[i], files[i]->Data(), files[i]->Size());
+		}
+		batch.Decode();
 
-			glBindTexture(GL_TEXTURE_2D, textureID);
-			glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-			glGenerateMipmap(GL_TEXTURE_2D);
+		for (size_t i = 0; i < count; i++)
+		{
+			if (ids[i] != 0)
+				continue;
+			glGenTextures(1, &ids[i]);
+			glBindTexture(GL_TEXTURE_2D, ids[i]);
+			if (slots[i] >= 0 && batch.Upload(slots[i], GL_TEXTURE_2D))
+			{
+				glGenerateMipmap(GL_TEXTURE_2D);
 
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, warp_s);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, warp_t);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, warp_s);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, warp_t);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
 
-			stbi_image_free(data);
-		}
-		else
-		{
-			std::cout << "Texture failed to load at path: " << texture_path << std::endl;
-			stbi_image_free(data);
+				const ImageDecodeBatch::Image& image = batch.Get(slots[i]);
+				ids[i] = TextureCache::Instance().Insert(keys[i], ids[i],
+					TextureCache::EstimateBytes(image.width, image.height, image.channels));
+			}
+			else
+			{
+				std::cout << "Texture failed to load at path: " << texture_paths[i] << std::endl;
+			}
 		}
-		return textureID;
+		if (batch.GetCount() > 0)
+			batch.Report("Textures");
+		return ids;
 	}
 
 };
@@ -5,6 +5,7 @@
 #include <Shader.h>
 #include <FileSystem.h>
 #include <Model.h>
+#include <model_loader.h>
 #include <Light.h>
 
 #include <list>
@@ -30,6 +31,7 @@ public:
 	static std::list<GameObject*> gameObjList;
 	static GameObject* selectedObject; // 当前选中的物体
 	static GameObject* movingObject; // 当前正在移动的物体
+	static ModelLoader* modelLoader; // 不为空时，之后创建的物体在后台加载模型，加载完成前不显示
 	
 public:
 	glm::vec3 pos;
@@ -43,7 +45,8 @@ public:
 private:
 	Model* model;
 	Light* light;
-
+	
+public:
 	// 获取世界空间的包围盒
 	AABB GetWorldAABB() const
 	{
@@ -83,8 +86,7 @@ private:
 		// << ")\n";
 		return box;
 	}
-	
-public:
+
 	GameObject(const std::string& modelPath,
 		const glm::mat4& modelMat = glm::mat4(1.0f), 
 		const glm::vec3 position = glm::vec3(0.0f),
@@ -96,7 +98,9 @@ public:
 	{
 		this->modelMat = modelMat;
 		this->modelPath = modelPath;
-		if (Model::modelList.find(FileSystem::getPath(modelPath)) == Model::modelList.end())
+		if (modelLoader != nullptr)
+			this->model = modelLoader->Load(modelPath, gamma);
+		else if (Model::modelList.find(FileSystem::getPath(modelPath)) == Model::modelList.end())
 		{
 			// 该模型未加载到List
 			Model* model = new Model(modelPath, gamma);
@@ -120,6 +124,9 @@ public:
 		gameObjList.remove(this);
 	}
 
+	// 模型已上传到 GPU，可以绘制和拾取
+	bool IsResident() const { return model->IsResident(); }
+
 	void Update()
 	{
 		modelMat = glm::translate(glm::mat4(1.0f), pos); // 位移
@@ -132,6 +139,7 @@ public:
 		const glm::mat4& viewMat = glm::mat4(1.0f),
 		const glm::vec4& clippling_plane = glm::vec4(0.0f, -1.0f, 0.0f, 999999.0f))
 	{
+		if (!IsResident()) return;
 		shader.use();
 		shader.setMat4("projection", projectionMat);
 		shader.setMat4("view", viewMat);
@@ -156,6 +164,7 @@ public:
     bool RayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDir, 
                           float maxDistance = 1000.0f)
     {
+        if (!IsResident()) return false;
         AABB box = GetWorldAABB();
         
         std::cout << "object: " << modelPath << "\n";
@@ -225,12 +234,18 @@ public:
 	void snaptoterrain(Terrain* terrain)
 	{
 		if(!isGround)return;
+		snaptoground(terrain->SampleHeight(pos.x, pos.z));
+	}
+
+	// 吸附到已查询好的地面高度（批量查询时使用）
+	void snaptoground(float ground_y)
+	{
+		if(!isGround || !IsResident())return;
 		/*
 		* 吸附到地面
 		*/
 		AABB box = GetWorldAABB();
 		float obj_bottom_y = box.min.y;
-		float ground_y = terrain->GetHeight(pos.x, pos.z);
 		float offset = obj_bottom_y - ground_y - 0.01f;// 让物体稍微埋入地面一点点，防止浮空
 		pos.y -= offset;
 		Update();
@@ -254,5 +269,6 @@ public:
 
 std::list<GameObject*> GameObject::gameObjList;
 GameObject* GameObject::selectedObject = nullptr;
+ModelLoader* GameObject::modelLoader = nullptr;
 
 #endif
\ No newline at end of file
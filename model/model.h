@@ -15,6 +15,10 @@
 
 #include <myinclude/mesh.h>
 #include <myinclude/shader.h>
+#include <model_cache.h>
+#include <content_hash.h>
+#include <texture_cache.h>
+#include <parallel.h>
 
 #include <string>
 #include <fstream>
@@ -23,9 +27,56 @@
 #include <map>
 #include <unordered_map>
 #include <vector>
+#include <memory>
+#include <chrono>
+#include <cctype>
 using namespace std;
 
-unsigned int TextureFromFile(const char *path, const string &directory, bool gamma = false);
+unsigned int UploadTexture(const unsigned char* data, int width, int height, int nrComponents);
+
+// 模型导入的 CPU 阶段产物：不含 GL 对象，可以在工作线程生成，再交给主线程上传
+struct ModelTextureData
+{
+    string type;
+    string path;
+    bool embedded = false;
+    int width = 0, height = 0, channels = 0;
+    vector<unsigned char> decoded;          // 导入时解码出的像素
+    const unsigned char* pixels = nullptr;  // 指向 decoded 或映射的缓存，解码失败时为空
+    uint64_t sharedKey = 0;                 // TextureCache 的键，0 表示不参与共享
+    unsigned int sharedId = 0;              // 导入时已在 TextureCache 中命中的纹理（已加引用）
+    const aiTexture* source = nullptr;      // 待解码的嵌入式纹理，只在 Assimp 导入期间有效
+    float decodeMs = 0.0f;                  // 工作线程上的解码耗时
+    float uploadMs = 0.0f;                  // 主线程上的上传耗时
+};
+
+struct ModelMeshData
+{
+    vector<Vertex> vertices;                // Assimp 导入时持有
+    vector<unsigned int> indices;
+    const Vertex* vertexData = nullptr;     // 从缓存导入时直接指向映射内存
+    const unsigned int* indexData = nullptr;
+    size_t vertexCount = 0, indexCount = 0;
+    vector<uint32_t> textureRefs;           // ModelData::textures 中的下标
+};
+
+struct ModelData
+{
+    string path;
+    string directory;
+    bool flipY = false;
+    bool valid = false;
+    bool keepPixels = false;                // 要写二进制缓存，共享命中的嵌入式纹理也要解码
+    int decodeThreads = 0;                  // 纹理解码的线程数上限，0 表示按硬件线程数
+    unique_ptr<ModelCache> cache;           // 上传完成前保持映射
+    vector<ModelMeshData> meshes;
+    vector<ModelTextureData> textures;
+    unordered_map<string, uint32_t> textureIndex;  // 纹理路径 -> textures 中的下标
+    glm::vec3 aabbMin = glm::vec3(FLT_MAX), aabbMax = glm::vec3(-FLT_MAX);
+    float importMs = 0.0f;                  // CPU 阶段耗时
+    float uploadMs = 0.0f;                  // GL 阶段累计耗时
+    size_t nextTexture = 0, nextMesh = 0;   // 上传进度
+};
 
 class Model 
 {
@@ -41,17 +92,36 @@ public:
     // constructor, expects a filepath to a 3D model.
     Model(string const &path, bool flipY = false) : flipY(flipY), aabb_min(glm::vec3(FLT_MAX)), aabb_max(glm::vec3(-FLT_MAX))
     {
-        if(modelList.find(path) != modelList.end())
+        auto loaded = modelList.find(path);
+        if(loaded != modelList.end() && loaded->second->IsResident())
         {
             // 模型已加载，直接使用现有实例
-            *this = *(modelList[path]);
+            *this = *(loaded->second);
             std::cout << "Model already loaded: " << path << ", reusing existing instance." << std::endl;
             return;
         }
-        loadModel(path);
-        modelList[path] = this; // 将模型存入静态列表
+        // 同步加载：在当前线程依次完成 CPU 阶段和 GL 阶段
+        ModelData data;
+        Import(path, flipY, data);
+        while (!UploadStep(data)) {}
+        // ModelLoader 正在加载同一路径时，列表中的占位由它完成，这里只保留自己的副本（纹理经 TextureCache 共用）
+        if(loaded == modelList.end())
+            modelList[path] = this; // 将模型存入静态列表
+    }
+
+    // 异步加载的占位：先登记到 modelList，网格和纹理由 ModelLoader 逐步上传
+    static Model* CreatePending(string const &path, bool flipY)
+    {
+        Model* model = new Model();
+        model->flipY = flipY;
+        model->directory = path.substr(0, path.find_last_of('/'));
+        modelList[path] = model;
+        return model;
     }
 
+    // 上传完成前没有网格，使用它的物体不绘制
+    bool IsResident() const { return resident; }
+
     // draws the model, and thus all its meshes
     void Draw(Shader &shader)
     {
@@ -59,19 +129,13 @@ public:
             meshes[i].Draw(shader);
     }
 
-    // 获取模型的原始包围盒（未缩放）
+    // 获取模型的原始包围盒（未缩放），尚未加载时为原点
     void GetBoundingBox(glm::vec3& min, glm::vec3& max) const
     {
         if(aabb_min.x == FLT_MAX && aabb_max.x == -FLT_MAX)
         {
-            for (const auto& mesh : meshes)
-            {
-                for (const auto& vertex : mesh.vertices)
-                {
-                    min = glm::min(min, vertex.Position);
-                    max = glm::max(max, vertex.Position);
-                }
-            }
+            min = glm::vec3(0.0f);
+            max = glm::vec3(0.0f);
         }
         else
         {
@@ -79,17 +143,108 @@ public:
             max = aabb_max;
         }
     }
+
+    // CPU 阶段，不调用 GL，可以在工作线程执行：优先读二进制缓存，缺失或过期时用 Assimp 导入、
+    // 转换顶点、解码纹理并重新生成缓存
+    static void Import(string const &path, bool flipY, ModelData& data)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        data.path = path;
+        data.flipY = flipY;
+        data.directory = path.substr(0, path.find_last_of('/'));
+
+        uint64_t key = CacheKey(path, flipY);
+        if (key == 0 || !importFromCache(key, data))
+        {
+            data.keepPixels = key != 0;
+            importWithAssimp(data);
+            if (key != 0 && data.valid)
+                writeCache(key, data);
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        data.importMs = std::chrono::duration<float, std::milli>(end - start).count();
+    }
+
+    // GL 阶段，只能在主线程执行：每次上传一个纹理或一个网格，全部完成后返回 true
+    bool UploadStep(ModelData& data)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        if (data.nextTexture < data.textures.size())
+        {
+            ModelTextureData& source = data.textures[data.nextTexture++];
+            auto uploadStart = std::chrono::high_resolution_clock::now();
+            Texture texture;
+            texture.id = source.sharedId;
+            // 其他模型可能在本模型导入之后才上传了同一张图
+            if (texture.id == 0 && source.sharedKey != 0)
+                texture.id = TextureCache::Instance().Acquire(source.sharedKey);
+            bool shared = texture.id != 0;
+            if (texture.id == 0)
+            {
+                texture.id = UploadTexture(source.pixels, source.width, source.height, source.channels);
+                // 解码失败的空纹理不参与共享
+                if (source.sharedKey != 0 && source.pixels)
+                    texture.id = TextureCache::Instance().Insert(source.sharedKey, texture.id,
+                        TextureCache::EstimateBytes(source.width, source.height, source.channels));
+            }
+            texture.type = source.type;
+            texture.path = source.path;
+            textures_loaded.push_back(texture);
+
+            auto uploadEnd = std::chrono::high_resolution_clock::now();
+            source.uploadMs = std::chrono::duration<float, std::milli>(uploadEnd - uploadStart).count();
+            std::cout << "  Texture " << source.path << " | ";
+            if (shared)
+                std::cout << "shared";
+            else if (source.pixels)
+                std::cout << source.width << "x" << source.height << "x" << source.channels;
+            else
+                std::cout << "failed";
+            std::cout << " | decode " << source.decodeMs << " ms (worker) | upload " << source.uploadMs << " ms" << std::endl;
+        }
+        else if (data.nextMesh < data.meshes.size())
+        {
+            ModelMeshData& source = data.meshes[data.nextMesh++];
+            vector<Texture> textures;
+            for (uint32_t ref : source.textureRefs)
+                textures.push_back(textures_loaded[ref]);
+            if (source.vertexData)
+                meshes.push_back(Mesh(source.vertexData, source.vertexCount, source.indexData, source.indexCount, textures));
+            else
+                meshes.push_back(Mesh(std::move(source.vertices), std::move(source.indices), textures));
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        data.uploadMs += std::chrono::duration<float, std::milli>(end - start).count();
+
+        if (data.nextTexture < data.textures.size() || data.nextMesh < data.meshes.size())
+            return false;
+
+        directory = data.directory;
+        aabb_min = data.aabbMin;
+        aabb_max = data.aabbMax;
+        data.cache.reset();
+        resident = true;
+        return true;
+    }
     
 private:
-    const aiScene* scene;  // 保存场景指针以访问嵌入式纹理
     glm::vec3 aabb_min, aabb_max; // 模型的轴对齐包围盒
+    bool resident = false;
+
+    Model() : flipY(false), aabb_min(glm::vec3(FLT_MAX)), aabb_max(glm::vec3(-FLT_MAX)) {}
     
-    // 加载嵌入式纹理
-    unsigned int LoadEmbeddedTexture(const aiTexture* aiTex)
+    // 解码嵌入式纹理，共享缓存中已有同样内容时跳过（要写模型缓存时仍需解码出像素）
+    static void DecodeEmbeddedTexture(const aiTexture* aiTex, ModelTextureData& texture, bool keepPixels)
     {
-        unsigned int textureID;
-        glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        size_t bytes = aiTex->mHeight == 0 ? aiTex->mWidth : static_cast<size_t>(aiTex->mWidth) * aiTex->mHeight * 4;
+        texture.sharedKey = TextureCache::Key(aiTex->pcData, bytes, TextureCache::ModelSampler());
+        texture.sharedId = TextureCache::Instance().Acquire(texture.sharedKey);
+        if (texture.sharedId != 0 && !keepPixels)
+        {
+            std::cout << "Shared embedded texture: " << texture.path << std::endl;
+            return;
+        }
 
         if (aiTex->mHeight == 0)
         {
@@ -103,17 +258,7 @@ private:
 
             if (data)
             {
-                GLenum format;
-                if (nrComponents == 1)
-                    format = GL_RED;
-                else if (nrComponents == 3)
-                    format = GL_RGB;
-                else if (nrComponents == 4)
-                    format = GL_RGBA;
-
-                glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-                glGenerateMipmap(GL_TEXTURE_2D);
-
+                SetPixels(texture, data, width, height, nrComponents);
                 stbi_image_free(data);
                 
                 std::cout << "Loaded embedded texture (compressed): " 
@@ -127,27 +272,249 @@ private:
         else
         {
             // 未压缩格式（原始像素数据）
-            GLenum format = GL_RGBA;
-            glTexImage2D(GL_TEXTURE_2D, 0, format, aiTex->mWidth, aiTex->mHeight, 0, format, GL_UNSIGNED_BYTE, aiTex->pcData);
-            glGenerateMipmap(GL_TEXTURE_2D);
+            SetPixels(texture, reinterpret_cast<const unsigned char*>(aiTex->pcData), aiTex->mWidth, aiTex->mHeight, 4);
             
             std::cout << "Loaded embedded texture (raw): " 
                       << aiTex->mWidth << "x" << aiTex->mHeight << std::endl;
         }
+    }
+
+    // 解码模型目录下的纹理文件（不含盘符的路径相对模型目录）
+    static void DecodeFileTexture(const string& directory, ModelTextureData& texture)
+    {
+        string filename = texture.path;
+        if(filename.find(':') == string::npos)
+            filename = directory + '/' + filename;
+
+        // 按文件内容查共享缓存，不同目录下的同名文件不会被误认为同一张图
+        MappedFile file;
+        if (!file.Open(filename))
+        {
+            std::cout << "      Texture failed to load at path: " << filename << std::endl;
+            return;
+        }
+        texture.sharedKey = TextureCache::Key(file.Data(), file.Size(), TextureCache::ModelSampler());
+        texture.sharedId = TextureCache::Instance().Acquire(texture.sharedKey);
+        if (texture.sharedId != 0)
+        {
+            std::cout << "      Texture shared: " << filename << std::endl;
+            return;
+        }
+
+        int width, height, nrComponents;
+        unsigned char *data = stbi_load_from_memory(file.Data(), static_cast<int>(file.Size()),
+                                                    &width, &height, &nrComponents, 0);
+        if (data)
+        {
+            SetPixels(texture, data, width, height, nrComponents);
+            stbi_image_free(data);
+            std::cout << "      Texture loaded: " << filename << " (" << width << "x" << height << ")" << std::endl;
+        }
+        else
+        {
+            std::cout << "      Texture failed to load at path: " << filename << std::endl;
+        }
+    }
+
+    // 材质遍历只登记纹理，收集完后多线程一起解码（嵌入式纹理和模型目录下的文件纹理），
+    // 缓存中已有像素的嵌入式纹理跳过
+    static void decodeTextures(ModelData& data)
+    {
+        ParallelFor(static_cast<int>(data.textures.size()), [&data](int i) {
+            ModelTextureData& texture = data.textures[i];
+            if (texture.embedded && !texture.source) return;
+            auto start = std::chrono::high_resolution_clock::now();
+            if (texture.source)
+                DecodeEmbeddedTexture(texture.source, texture, data.keepPixels);
+            else
+                DecodeFileTexture(data.directory, texture);
+            texture.source = nullptr;
+            auto end = std::chrono::high_resolution_clock::now();
+            texture.decodeMs = std::chrono::duration<float, std::milli>(end - start).count();
+        }, 1, data.decodeThreads);
+    }
+
+    static void SetPixels(ModelTextureData& texture, const unsigned char* data, int width, int height, int nrComponents)
+    {
+        texture.width = width;
+        texture.height = height;
+        texture.channels = nrComponents;
+        texture.decoded.assign(data, data + static_cast<size_t>(width) * height * nrComponents);
+        texture.pixels = texture.decoded.data();
+    }
+
+    // 缓存键：模型文件及其旁文件的内容 + 导入参数 + 顶点结构
+    static uint64_t CacheKey(const string& path, bool flipY)
+    {
+        uint64_t key = ContentHash::HashFile(path);
+        if (key == 0) return 0;
+        // 旁文件缺失时按 0 计入，补上文件后键也会变化
+        string directory = path.substr(0, path.find_last_of('/'));
+        for (const string& side : SideFiles(path))
+            key = ContentHash::HashValue(ContentHash::HashFile(directory + '/' + side), key);
+        key = ContentHash::HashValue(flipY, key);
+        key = ContentHash::HashValue(static_cast<uint32_t>(sizeof(Vertex)), key);
+        return key;
+    }
+
+    // 模型引用的外部文件（相对模型目录）：.obj 的 mtllib（材质表）、.gltf 的外部 buffer 和图片（uri），
+    // 它们的内容决定缓存里的网格和材质表，改动后缓存必须失效
+    static vector<string> SideFiles(const string& path)
+    {
+        vector<string> files;
+        string ext = path.substr(path.find_last_of('.') + 1);
+        for (char& c : ext) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        if (ext != "obj" && ext != "gltf") return files;
+
+        MappedFile file;
+        if (!file.Open(path)) return files;
+        string text(reinterpret_cast<const char*>(file.Data()), file.Size());
+
+        if (ext == "obj")
+        {
+            std::istringstream lines(text);
+            string line;
+            while (std::getline(lines, line))
+            {
+                if (line.compare(0, 6, "mtllib") != 0 || line.size() < 7 || !isspace(static_cast<unsigned char>(line[6])))
+                    continue;
+                size_t begin = line.find_first_not_of(" \t", 6);
+                size_t end = line.find_last_not_of(" \t\r");
+                if (begin != string::npos && end >= begin)
+                    files.push_back(line.substr(begin, end - begin + 1));
+            }
+        }
+        else
+        {
+            // 内嵌的 data: URI 不是文件
+            for (size_t pos = text.find("\"uri\""); pos != string::npos; pos = text.find("\"uri\"", pos + 5))
+            {
+                size_t begin = text.find('"', text.find(':', pos + 5));
+                size_t end = begin == string::npos ? string::npos : text.find('"', begin + 1);
+                if (end == string::npos) break;
+                string uri = text.substr(begin + 1, end - begin - 1);
+                if (uri.compare(0, 5, "data:") != 0)
+                    files.push_back(uri);
+            }
+        }
+        return files;
+    }
+
+    // 从二进制缓存导入：顶点/索引和嵌入式纹理的像素直接指向映射内存，无需解析和解码
+    static bool importFromCache(uint64_t key, ModelData& data)
+    {
+        unique_ptr<ModelCache> cache(new ModelCache());
+        if (!cache->Open(ModelCache::CachePath(data.path, key), key, sizeof(Vertex)))
+            return false;
+
+        const ModelCacheHeader& header = cache->GetHeader();
+        for (uint32_t i = 0; i < header.textureCount; i++)
+        {
+            const ModelCacheTexture& record = cache->GetTextures()[i];
+            ModelTextureData texture;
+            texture.type = cache->GetString(record.typeOffset, record.typeLength);
+            texture.path = cache->GetString(record.pathOffset, record.pathLength);
+            texture.embedded = record.embedded != 0;
+            if (texture.embedded)
+            {
+                texture.sharedKey = record.sharedKey;
+                texture.sharedId = TextureCache::Instance().Acquire(record.sharedKey);
+                texture.width = record.width;
+                texture.height = record.height;
+                texture.channels = record.channels;
+                if (texture.sharedId == 0 && record.pixelBytes)
+                    texture.pixels = cache->GetPixels() + record.pixelOffset;
+            }
+            data.textures.push_back(std::move(texture));
+        }
+        decodeTextures(data);
+
+        const Vertex* vertices = static_cast<const Vertex*>(cache->GetVertices());
+        for (uint32_t i = 0; i < header.meshCount; i++)
+        {
+            const ModelCacheMesh& record = cache->GetMeshes()[i];
+            ModelMeshData mesh;
+            mesh.vertexData = vertices + record.firstVertex;
+            mesh.vertexCount = record.vertexCount;
+            mesh.indexData = cache->GetIndices() + record.firstIndex;
+            mesh.indexCount = record.indexCount;
+            const uint32_t* refs = cache->GetTextureRefs() + record.firstTextureRef;
+            mesh.textureRefs.assign(refs, refs + record.textureRefCount);
+            data.meshes.push_back(std::move(mesh));
+        }
+
+        data.aabbMin = glm::vec3(header.aabbMin[0], header.aabbMin[1], header.aabbMin[2]);
+        data.aabbMax = glm::vec3(header.aabbMax[0], header.aabbMax[1], header.aabbMax[2]);
+        data.cache = std::move(cache);
+        data.valid = true;
+
+        std::cout << "Model loaded from cache: " << data.path << " (" << header.meshCount << " meshes, "
+                  << header.textureCount << " textures)" << std::endl;
+        return true;
+    }
+
+    // 导入完成后把网格、纹理表和包围盒写入缓存（文件纹理只记路径）
+    static void writeCache(uint64_t key, const ModelData& data)
+    {
+        ModelCache::Builder builder;
+        builder.vertexStride = sizeof(Vertex);
+        for (const ModelTextureData& texture : data.textures)
+        {
+            ModelCacheTexture record = {};
+            record.typeOffset = builder.AddString(texture.type);
+            record.typeLength = static_cast<uint32_t>(texture.type.size());
+            record.pathOffset = builder.AddString(texture.path);
+            record.pathLength = static_cast<uint32_t>(texture.path.size());
+            record.embedded = texture.embedded ? 1 : 0;
+            if (texture.embedded)
+                record.sharedKey = texture.sharedKey;
+            if (texture.embedded && texture.pixels)
+            {
+                size_t bytes = static_cast<size_t>(texture.width) * texture.height * texture.channels;
+                record.width = texture.width;
+                record.height = texture.height;
+                record.channels = texture.channels;
+                record.pixelOffset = builder.pixels.size();
+                record.pixelBytes = bytes;
+                builder.pixels.insert(builder.pixels.end(), texture.pixels, texture.pixels + bytes);
+            }
+            builder.textures.push_back(record);
+        }
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        for (const ModelMeshData& mesh : data.meshes)
+        {
+            ModelCacheMesh record = {};
+            record.firstVertex = static_cast<uint32_t>(builder.vertices.size() / sizeof(Vertex));
+            record.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+            record.firstIndex = static_cast<uint32_t>(builder.indices.size());
+            record.indexCount = static_cast<uint32_t>(mesh.indices.size());
+            record.firstTextureRef = static_cast<uint32_t>(builder.textureRefs.size());
+            record.textureRefCount = static_cast<uint32_t>(mesh.textureRefs.size());
+
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(mesh.vertices.data());
+            builder.vertices.insert(builder.vertices.end(), bytes, bytes + mesh.vertices.size() * sizeof(Vertex));
+            builder.indices.insert(builder.indices.end(), mesh.indices.begin(), mesh.indices.end());
+            builder.textureRefs.insert(builder.textureRefs.end(), mesh.textureRefs.begin(), mesh.textureRefs.end());
+            builder.meshes.push_back(record);
+        }
+        for (int k = 0; k < 3; k++)
+        {
+            builder.aabbMin[k] = data.aabbMin[k];
+            builder.aabbMax[k] = data.aabbMax[k];
+        }
 
-        return textureID;
+        string cachePath = ModelCache::CachePath(data.path, key);
+        if (ModelCache::Write(cachePath, key, builder))
+            std::cout << "Model cache written: " << cachePath << std::endl;
+        else
+            std::cout << "Failed to write model cache for " << data.path << std::endl;
     }
     
-    // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
-    void loadModel(string const &path)
+    // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in data.
+    static void importWithAssimp(ModelData& data)
     {
         Assimp::Importer importer;
-        scene = importer.ReadFile(path, 
+        const aiScene* scene = importer.ReadFile(data.path, 
             aiProcess_Triangulate | 
             aiProcess_GenSmoothNormals | 
             aiProcess_FlipUVs | 
@@ -158,34 +525,43 @@ private:
             cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
             return;
         }
-        
-        directory = path.substr(0, path.find_last_of('/'));
 
         // 输出加载信息
         std::cout << "========================================" << std::endl;
-        std::cout << "Model loaded: " << path << std::endl;
-        std::cout << "Directory: " << directory << std::endl;
+        std::cout << "Model loaded: " << data.path << std::endl;
+        std::cout << "Directory: " << data.directory << std::endl;
         std::cout << "Meshes: " << scene->mNumMeshes << std::endl;
         std::cout << "Materials: " << scene->mNumMaterials << std::endl;
         std::cout << "Embedded textures: " << scene->mNumTextures << std::endl;
         std::cout << "========================================" << std::endl;
 
-        processNode(scene->mRootNode, scene);
+        processNode(scene->mRootNode, scene, data);
+        decodeTextures(data);
+
+        for (const auto& mesh : data.meshes)
+        {
+            for (const auto& vertex : mesh.vertices)
+            {
+                data.aabbMin = glm::min(data.aabbMin, vertex.Position);
+                data.aabbMax = glm::max(data.aabbMax, vertex.Position);
+            }
+        }
+        data.valid = true;
         
         std::cout << "Model processing complete!" << std::endl;
     }
 
-    void processNode(aiNode *node, const aiScene *scene)
+    static void processNode(aiNode *node, const aiScene *scene, ModelData& data)
     {
         for(unsigned int i = 0; i < node->mNumMeshes; i++)
         {
             aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.push_back(processMesh(mesh, scene));
+            data.meshes.push_back(processMesh(mesh, scene, data));
         }
         
         for(unsigned int i = 0; i < node->mNumChildren; i++)
         {
-            processNode(node->mChildren[i], scene);
+            processNode(node->mChildren[i], scene, data);
         }
     }
 
@@ -285,11 +661,13 @@ private:
     //     return Mesh(vertices, indices, textures);
     // }
 
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene)
+    static ModelMeshData processMesh(aiMesh *mesh, const aiScene *scene, ModelData& data)
     {
-        vector<Vertex> vertices;
-        vector<unsigned int> indices;
-        vector<Texture> textures;
+        ModelMeshData result;
+        vector<Vertex>& vertices = result.vertices;
+        vector<unsigned int>& indices = result.indices;
+        vector<uint32_t>& textures = result.textureRefs;
+        bool flipY = data.flipY;
 
         for(unsigned int i = 0; i < mesh->mNumVertices; i++)
         {
@@ -353,38 +731,36 @@ private:
                     indices.push_back(face.mIndices[j]);
             }
         }
+        result.vertexCount = vertices.size();
+        result.indexCount = indices.size();
         
         // 处理材质
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
     
         // 1. 漫反射贴图
-        vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-        textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+        loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", scene, data, textures);
         
         // 2. 镜面反射贴图
-        vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-        textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+        loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular", scene, data, textures);
         
         // 3. 法线贴图
-        std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-        textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+        loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal", scene, data, textures);
         
         // 4. 高度贴图
-        std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-        textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
+        loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height", scene, data, textures);
         
         std::cout << " | Mesh: " << (mesh->mName.length > 0 ? mesh->mName.C_Str() : "unnamed") 
                 << " | Vertices: " << vertices.size() 
                 << " | Indices: " << indices.size()
                 << " | Textures: " << textures.size() << std::endl;
         
-        return Mesh(vertices, indices, textures);
+        return result;
     }
 
-    // 支持嵌入式纹理
-    vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName)
+    // 支持嵌入式纹理，把材质用到的纹理在 data.textures 中的下标追加到 refs
+    static void loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName,
+                                     const aiScene* scene, ModelData& data, vector<uint32_t>& refs)
     {
-        vector<Texture> textures;
         for(unsigned int i = 0; i < mat->GetTextureCount(type); i++)
         {
             aiString str;
@@ -399,20 +775,16 @@ private:
             }
             
             // 检查是否已加载
-            bool skip = false;
-            for(unsigned int j = 0; j < textures_loaded.size(); j++)
+            auto loaded = data.textureIndex.find(texturePath);
+            if (loaded != data.textureIndex.end())
             {
-                if(std::strcmp(textures_loaded[j].path.data(), texturePath.c_str()) == 0)
-                {
-                    textures.push_back(textures_loaded[j]);
-                    skip = true;
-                    break;
-                }
+                refs.push_back(loaded->second);
             }
-            
-            if(!skip)
+            else
             {
-                Texture texture;
+                ModelTextureData texture;
+                texture.type = typeName;
+                texture.path = texturePath;
                 
                 // 检查是否是嵌入式纹理（Assimp 使用 "*" 前缀）
                 if(texturePath[0] == '*')
@@ -421,8 +793,9 @@ private:
                     
                     if(scene && textureIndex >= 0 && textureIndex < static_cast<int>(scene->mNumTextures))
                     {
-                        texture.id = LoadEmbeddedTexture(scene->mTextures[textureIndex]);
-                        std::cout << "Loaded embedded texture [" << textureIndex << "] for " << typeName << std::endl;
+                        texture.embedded = true;
+                        texture.source = scene->mTextures[textureIndex];
+                        std::cout << "Found embedded texture [" << textureIndex << "] for " << typeName << std::endl;
                     }
                     else
                     {
@@ -432,41 +805,29 @@ private:
                 }
                 else
                 {
-                    // 从文件系统加载纹理
-                    texture.id = TextureFromFile(texturePath.c_str(), this->directory);
-                    std::cout << "Loaded file texture: " << texturePath << " for " << typeName << std::endl;
+                    // 从文件系统加载纹理（在 decodeTextures 中解码）
+                    std::cout << "Found file texture: " << texturePath << " for " << typeName << std::endl;
                 }
                 
-                texture.type = typeName;
-                texture.path = texturePath;
-                textures.push_back(texture);
-                textures_loaded.push_back(texture);
+                uint32_t index = static_cast<uint32_t>(data.textures.size());
+                data.textureIndex[texturePath] = index;
+                refs.push_back(index);
+                data.textures.push_back(std::move(texture));
             }
         }
-        return textures;
     }
 };
 
-// 改进 TextureFromFile 函数
-unsigned int TextureFromFile(const char *path, const string &directory, bool gamma)
+// 按通道数上传像素并生成 mipmap，data 为空时只创建纹理对象
+unsigned int UploadTexture(const unsigned char* data, int width, int height, int nrComponents)
 {
-    string filename = string(path);
-    
-    // 如果不是绝对路径，添加目录前缀
-    if(filename.find(':') == string::npos)
-    {
-        filename = directory + '/' + filename;
-    }
-
     unsigned int textureID;
     glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
 
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    
     if (data)
     {
-        GLenum format;
+        GLenum format = GL_RGBA;
         if (nrComponents == 1)
             format = GL_RED;
         else if (nrComponents == 3)
@@ -474,25 +835,15 @@ unsigned int TextureFromFile(const char *path, const string &directory, bool gam
         else if (nrComponents == 4)
             format = GL_RGBA;
 
-        glBindTexture(GL_TEXTURE_2D, textureID);
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-        
-        std::cout << "      Texture loaded: " << filename << " (" << width << "x" << height << ")" << std::endl;
-    }
-    else
-    {
-        std::cout << "      Texture failed to load at path: " << filename << std::endl;
-        stbi_image_free(data);
     }
 
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
     return textureID;
 }
 
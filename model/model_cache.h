@@ -0,0 +1,249 @@
+#ifndef MODEL_CACHE_H
+#define MODEL_CACHE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <thread>
+#include <functional>
+#include <mapped_file.h>
+
+// 模型二进制缓存：保存 Assimp 导入并转换后的顶点/索引流、材质纹理表、包围盒和已解码的嵌入式纹理，
+// 下次启动时内存映射后直接上传，跳过 ReadFile（三角化、平滑法线、切线计算）和图片解码。
+//
+// 文件布局：ModelCacheHeader，随后依次为（每段都补齐到 8 字节）
+//   ModelCacheMesh meshes[meshCount]
+//   ModelCacheTexture textures[textureCount]
+//   uint32 textureRefs[textureRefCount]（每个网格引用的纹理下标，按网格连续存放）
+//   char strings[stringBytes]（纹理类型和路径）
+//   <顶点结构> vertices[vertexCount]（字节数 vertexCount * vertexStride）
+//   uint32 indices[indexCount]
+//   uint8 pixels[pixelBytes]（嵌入式纹理解码后的像素；文件纹理只存路径，仍从磁盘读取）
+// 缓存键由模型文件内容哈希与导入参数组成，任一变化都会生成新文件。
+
+struct ModelCacheHeader
+{
+    char magic[4];          // "MDC1"
+    uint32_t version;
+    uint64_t key;
+    uint32_t vertexStride;  // sizeof(Vertex)，结构变化时缓存自动失效
+    uint32_t meshCount;
+    uint32_t textureCount;
+    uint32_t textureRefCount;
+    uint32_t stringBytes;
+    uint32_t reserved;
+    float aabbMin[3];
+    float aabbMax[3];
+    uint64_t vertexCount;
+    uint64_t indexCount;
+    uint64_t pixelBytes;
+};
+
+struct ModelCacheMesh
+{
+    uint32_t firstVertex, vertexCount;
+    uint32_t firstIndex, indexCount;   // 索引相对本网格的第一个顶点
+    uint32_t firstTextureRef, textureRefCount;
+};
+
+struct ModelCacheTexture
+{
+    uint32_t typeOffset, typeLength;   // 在 strings 中的位置
+    uint32_t pathOffset, pathLength;
+    int32_t width, height, channels;
+    uint32_t embedded;                 // 1：像素在 pixels 段中；0：按路径从模型目录读取
+    uint64_t pixelOffset, pixelBytes;  // 嵌入式纹理解码失败时 pixelBytes 为 0
+    uint64_t sharedKey;                // 嵌入式纹理在 TextureCache 中的键，命中时不必读取像素
+};
+
+class ModelCache
+{
+public:
+    static const uint32_t VERSION = 2;
+
+    // 写入端：导入时逐项填充，最后一次写出
+    struct Builder
+    {
+        std::vector<ModelCacheMesh> meshes;
+        std::vector<ModelCacheTexture> textures;
+        std::vector<uint32_t> textureRefs;
+        std::string strings;
+        std::vector<unsigned char> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<uint8_t> pixels;
+        uint32_t vertexStride = 0;
+        float aabbMin[3] = { 0.0f, 0.0f, 0.0f };
+        float aabbMax[3] = { 0.0f, 0.0f, 0.0f };
+
+        // 返回字符串在 strings 中的偏移
+        uint32_t AddString(const std::string& s)
+        {
+            uint32_t offset = static_cast<uint32_t>(strings.size());
+            strings += s;
+            return offset;
+        }
+    };
+
+    // 缓存文件放在模型旁边：<模型>.<键>.mcache
+    static std::string CachePath(const std::string& modelPath, uint64_t key)
+    {
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+        return modelPath + "." + hex + ".mcache";
+    }
+
+    // 打开并校验缓存，成功后各段指针指向映射内存，在 Close 前有效
+    bool Open(const std::string& path, uint64_t key, uint32_t vertexStride)
+    {
+        if (!m_file.Open(path) || m_file.Size() < sizeof(ModelCacheHeader)) {
+            m_file.Close();
+            return false;
+        }
+        std::memcpy(&m_header, m_file.Data(), sizeof(m_header));
+        if (std::memcmp(m_header.magic, "MDC1", 4) != 0 || m_header.version != VERSION ||
+            m_header.key != key || m_header.vertexStride != vertexStride) {
+            m_file.Close();
+            return false;
+        }
+
+        size_t offset = sizeof(ModelCacheHeader);
+        size_t meshesOffset = offset;    offset += Align(m_header.meshCount * sizeof(ModelCacheMesh));
+        size_t texturesOffset = offset;  offset += Align(m_header.textureCount * sizeof(ModelCacheTexture));
+        size_t refsOffset = offset;      offset += Align(m_header.textureRefCount * sizeof(uint32_t));
+        size_t stringsOffset = offset;   offset += Align(m_header.stringBytes);
+        size_t verticesOffset = offset;  offset += Align(static_cast<size_t>(m_header.vertexCount) * vertexStride);
+        size_t indicesOffset = offset;   offset += Align(static_cast<size_t>(m_header.indexCount) * sizeof(uint32_t));
+        size_t pixelsOffset = offset;    offset += static_cast<size_t>(m_header.pixelBytes);
+        if (m_file.Size() != offset) {
+            m_file.Close();
+            return false;
+        }
+
+        const unsigned char* base = m_file.Data();
+        m_meshes = reinterpret_cast<const ModelCacheMesh*>(base + meshesOffset);
+        m_textures = reinterpret_cast<const ModelCacheTexture*>(base + texturesOffset);
+        m_textureRefs = reinterpret_cast<const uint32_t*>(base + refsOffset);
+        m_strings = reinterpret_cast<const char*>(base + stringsOffset);
+        m_vertices = base + verticesOffset;
+        m_indices = reinterpret_cast<const uint32_t*>(base + indicesOffset);
+        m_pixels = base + pixelsOffset;
+
+        // 越界的引用说明文件损坏，当作缓存缺失处理
+        for (uint32_t i = 0; i < m_header.meshCount; i++) {
+            const ModelCacheMesh& mesh = m_meshes[i];
+            if (static_cast<uint64_t>(mesh.firstVertex) + mesh.vertexCount > m_header.vertexCount ||
+                static_cast<uint64_t>(mesh.firstIndex) + mesh.indexCount > m_header.indexCount ||
+                static_cast<uint64_t>(mesh.firstTextureRef) + mesh.textureRefCount > m_header.textureRefCount) {
+                m_file.Close();
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < m_header.textureRefCount; i++) {
+            if (m_textureRefs[i] >= m_header.textureCount) {
+                m_file.Close();
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < m_header.textureCount; i++) {
+            const ModelCacheTexture& texture = m_textures[i];
+            if (static_cast<uint64_t>(texture.typeOffset) + texture.typeLength > m_header.stringBytes ||
+                static_cast<uint64_t>(texture.pathOffset) + texture.pathLength > m_header.stringBytes ||
+                texture.pixelOffset + texture.pixelBytes > m_header.pixelBytes) {
+                m_file.Close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Close() { m_file.Close(); }
+
+    const ModelCacheHeader& GetHeader() const { return m_header; }
+    const ModelCacheMesh* GetMeshes() const { return m_meshes; }
+    const ModelCacheTexture* GetTextures() const { return m_textures; }
+    const uint32_t* GetTextureRefs() const { return m_textureRefs; }
+    const void* GetVertices() const { return m_vertices; }
+    const uint32_t* GetIndices() const { return m_indices; }
+    const uint8_t* GetPixels() const { return m_pixels; }
+
+    std::string GetString(uint32_t offset, uint32_t length) const
+    {
+        return std::string(m_strings + offset, length);
+    }
+
+    // 写到临时文件再改名，中途失败不会留下半个缓存。
+    // 临时文件名带进程号和线程号：同一模型可能同时被 ModelLoader 和同步构造各导入一次，不能写进同一个文件
+    static bool Write(const std::string& path, uint64_t key, const Builder& builder)
+    {
+        ModelCacheHeader header = {};
+        std::memcpy(header.magic, "MDC1", 4);
+        header.version = VERSION;
+        header.key = key;
+        header.vertexStride = builder.vertexStride;
+        header.meshCount = static_cast<uint32_t>(builder.meshes.size());
+        header.textureCount = static_cast<uint32_t>(builder.textures.size());
+        header.textureRefCount = static_cast<uint32_t>(builder.textureRefs.size());
+        header.stringBytes = static_cast<uint32_t>(builder.strings.size());
+        std::memcpy(header.aabbMin, builder.aabbMin, sizeof(header.aabbMin));
+        std::memcpy(header.aabbMax, builder.aabbMax, sizeof(header.aabbMax));
+        header.vertexCount = builder.vertexStride ? builder.vertices.size() / builder.vertexStride : 0;
+        header.indexCount = builder.indices.size();
+        header.pixelBytes = builder.pixels.size();
+
+        std::string tmpPath = path + "." + std::to_string(ProcessId()) + "." +
+            std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary);
+            if (!out) return false;
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            WriteAligned(out, builder.meshes.data(), builder.meshes.size() * sizeof(ModelCacheMesh));
+            WriteAligned(out, builder.textures.data(), builder.textures.size() * sizeof(ModelCacheTexture));
+            WriteAligned(out, builder.textureRefs.data(), builder.textureRefs.size() * sizeof(uint32_t));
+            WriteAligned(out, builder.strings.data(), builder.strings.size());
+            WriteAligned(out, builder.vertices.data(), builder.vertices.size());
+            WriteAligned(out, builder.indices.data(), builder.indices.size() * sizeof(uint32_t));
+            out.write(reinterpret_cast<const char*>(builder.pixels.data()), builder.pixels.size());
+            if (!out) {
+                out.close();
+                std::remove(tmpPath.c_str());
+                return false;
+            }
+        }
+        std::remove(path.c_str());
+        return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+    }
+
+private:
+    MappedFile m_file;
+    ModelCacheHeader m_header = {};
+    const ModelCacheMesh* m_meshes = nullptr;
+    const ModelCacheTexture* m_textures = nullptr;
+    const uint32_t* m_textureRefs = nullptr;
+    const char* m_strings = nullptr;
+    const void* m_vertices = nullptr;
+    const uint32_t* m_indices = nullptr;
+    const uint8_t* m_pixels = nullptr;
+
+    static unsigned long ProcessId()
+    {
+#ifdef _WIN32
+        return static_cast<unsigned long>(GetCurrentProcessId());
+#else
+        return static_cast<unsigned long>(getpid());
+#endif
+    }
+
+    static size_t Align(size_t bytes) { return (bytes + 7) & ~static_cast<size_t>(7); }
+
+    static void WriteAligned(std::ofstream& out, const void* data, size_t bytes)
+    {
+        static const char zeros[8] = {};
+        out.write(static_cast<const char*>(data), bytes);
+        out.write(zeros, Align(bytes) - bytes);
+    }
+};
+
+#endif // MODEL_CACHE_H
@@ -0,0 +1,160 @@
+#ifndef MODEL_LOADER_H
+#define MODEL_LOADER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include "model.h"
+
+// 异步模型加载：CPU 阶段（读缓存或 Assimp 解析、顶点转换、纹理解码）由工作线程并行完成，
+// GL 阶段在主线程每帧按时间预算逐项上传（一次一个纹理或一个网格），几十个模型也不会卡住画面。
+//
+// Load 立即返回登记到 Model::modelList 的实例，上传完成前 IsResident() 为 false，
+// 使用它的物体保持隐藏；同一路径只导入一次。
+class ModelLoader
+{
+public:
+    explicit ModelLoader(int workerCount = 0)
+    {
+        if (workerCount <= 0) {
+            int hw = static_cast<int>(std::thread::hardware_concurrency());
+            workerCount = std::min(hw > 0 ? hw : 4, 8);
+        }
+        // 每个工作线程内部还会并行解码纹理，按硬件线程数平分，总线程数不超过核数
+        int hw = static_cast<int>(std::thread::hardware_concurrency());
+        m_decodeThreads = std::max(1, (hw > 0 ? hw : 4) / workerCount);
+        for (int i = 0; i < workerCount; i++)
+            m_workers.emplace_back(&ModelLoader::WorkerLoop, this);
+    }
+
+    ~ModelLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (auto& worker : m_workers) worker.join();
+    }
+
+    ModelLoader(const ModelLoader&) = delete;
+    ModelLoader& operator=(const ModelLoader&) = delete;
+
+    Model* Load(const std::string& path, bool flipY = false)
+    {
+        auto it = Model::modelList.find(path);
+        if (it != Model::modelList.end())
+            return it->second;
+
+        if (m_pending == 0)
+            m_batchStart = std::chrono::high_resolution_clock::now();
+        m_pending++;
+
+        std::unique_ptr<Job> job(new Job());
+        job->model = Model::CreatePending(path, flipY);
+        job->path = path;
+        job->flipY = flipY;
+        job->data.decodeThreads = m_decodeThreads;
+        Model* model = job->model;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_requests.push_back(std::move(job));
+        }
+        m_cv.notify_one();
+        return model;
+    }
+
+    // 每帧在主线程调用一次：在 budgetMs 内上传已导入完的模型，每帧至少推进一步
+    void Update(float budgetMs = 4.0f)
+    {
+        m_frame++;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& job : m_completed)
+                m_uploading.push_back(std::move(job));
+            m_completed.clear();
+        }
+        if (m_uploading.empty()) return;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        while (!m_uploading.empty()) {
+            Job& job = *m_uploading.front();
+            if (job.firstFrame == 0) job.firstFrame = m_frame;
+
+            if (job.model->UploadStep(job.data)) {
+                std::cout << "Model resident: " << job.path << " | import " << job.data.importMs
+                          << " ms (worker) | upload " << job.data.uploadMs << " ms over "
+                          << m_frame - job.firstFrame + 1 << " frame(s)" << std::endl;
+                m_uploading.pop_front();
+                if (--m_pending == 0) {
+                    auto end = std::chrono::high_resolution_clock::now();
+                    std::cout << "All models resident in "
+                              << std::chrono::duration<float, std::milli>(end - m_batchStart).count()
+                              << " ms" << std::endl;
+                    TextureCache::Instance().PrintStats();
+                }
+            }
+
+            auto now = std::chrono::high_resolution_clock::now();
+            if (std::chrono::duration<float, std::milli>(now - start).count() >= budgetMs)
+                break;
+        }
+    }
+
+    // 尚未上传完成的模型数
+    int GetPendingCount() const { return m_pending; }
+    bool IsIdle() const { return m_pending == 0; }
+
+private:
+    struct Job
+    {
+        Model* model = nullptr;
+        std::string path;
+        bool flipY = false;
+        ModelData data;
+        int firstFrame = 0;
+    };
+
+    // 后台导入（m_mutex 保护）
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::unique_ptr<Job>> m_requests;
+    std::vector<std::unique_ptr<Job>> m_completed;
+    bool m_stop = false;
+    int m_decodeThreads = 1;
+
+    // 上传队列与统计（仅主线程访问）
+    std::deque<std::unique_ptr<Job>> m_uploading;
+    int m_pending = 0;
+    int m_frame = 0;
+    std::chrono::high_resolution_clock::time_point m_batchStart;
+
+    void WorkerLoop()
+    {
+        while (true) {
+            std::unique_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this]() { return m_stop || !m_requests.empty(); });
+                if (m_stop) return;
+                job = std::move(m_requests.front());
+                m_requests.pop_front();
+            }
+
+            Model::Import(job->path, job->flipY, job->data);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed.push_back(std::move(job));
+        }
+    }
+};
+
+#endif // MODEL_LOADER_H
@@ -2,6 +2,7 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <fstream>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -32,6 +33,16 @@ float worldTime = 0.0f;      // 昼夜系统用的“世界时间”
 float timeScale = 0.2f;      // 默认时间倍率（<1 表示比真实时间慢）
 bool fastTime = false;       // 是否处于加速状态
 
+bool screenSpaceRefraction = false;   // 水面折射是否使用屏幕空间方式
+bool refractionKeyPressed = false;
+WaterQuality waterQuality = WaterQuality::Low;   // 水面画质档位
+bool qualityKeyPressed = false;
+bool temporalWaterUpdate = true;   // 反射/折射缓冲是否分帧更新
+bool temporalKeyPressed = false;
+
+Scene* pickScene = nullptr;   // 鼠标拾取和挖沙用的场景（按当前高度来源求交），场景创建后设置
+bool proceduralTerrain = false;   // 没有 coast.hft 时改用程序化生成的大范围沙滩
+
 Camera camera(glm::vec3(0.0f, 30.0f, 50.0f), glm::vec3(0.0f, 1.0f, 0.0f), -90.0f, -45.0f);
 void processInput(GLFWwindow* window)
 {
@@ -61,6 +72,42 @@ void processInput(GLFWwindow* window)
         blinnKeyPressed = false;
     }
 
+    // 按 R 键切换水面折射方式（平面折射 / 屏幕空间折射）
+    if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS && !refractionKeyPressed)
+    {
+        screenSpaceRefraction = !screenSpaceRefraction;
+        refractionKeyPressed = true;
+        std::cout << "Refraction mode: " << (screenSpaceRefraction ? "screen-space" : "planar") << std::endl;
+    }
+    if (glfwGetKey(window, GLFW_KEY_R) == GLFW_RELEASE)
+    {
+        refractionKeyPressed = false;
+    }
+
+    // 按 Q 键循环切换水面画质档位（低 / 中 / 高）
+    if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS && !qualityKeyPressed)
+    {
+        waterQuality = static_cast<WaterQuality>((static_cast<int>(waterQuality) + 1) % 3);
+        qualityKeyPressed = true;
+        const char* names[] = { "low", "medium", "high" };
+        std::cout << "Water quality: " << names[static_cast<int>(waterQuality)] << std::endl;
+    }
+    if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_RELEASE)
+    {
+        qualityKeyPressed = false;
+    }
+
+    // 按 T 键开关反射/折射缓冲的分帧更新
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && !temporalKeyPressed)
+    {
+        temporalWaterUpdate = !temporalWaterUpdate;
+        temporalKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE)
+    {
+        temporalKeyPressed = false;
+    }
+
     // 按 F 键切换时间快/慢
     if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS && !fastTime)
     {
@@ -98,6 +145,36 @@ void ScreenToWorldRay(double mouseX, double mouseY, Camera& camera,
     rayOrigin = camera.Position;
 }
 
+// 鼠标射线与地面的交点：优先与地形高度场求交，射线没有碰到地形时退回 y=0 平面
+bool PickGround(const glm::vec3& rayOrigin, const glm::vec3& rayDir, glm::vec3& hitPoint)
+{
+    if (pickScene && pickScene->Raycast(rayOrigin, rayDir, hitPoint))
+        return true;
+    if (std::abs(rayDir.y) < 1e-6f)
+        return false;
+    float t = -rayOrigin.y / rayDir.y;
+    hitPoint = rayOrigin + rayDir * t;
+    hitPoint.y = 0.0f;
+    return t > 0.0f;
+}
+
+// 按住 E 键在光标处挖沙，按住 Shift + E 堆沙；形变在 Scene::Update 中统一提交（分页地形只读，不支持）
+void SculptTerrain(GLFWwindow* window)
+{
+    if (!pickScene || !pickScene->CanDeform() || glfwGetKey(window, GLFW_KEY_E) != GLFW_PRESS)
+        return;
+
+    double xpos, ypos;
+    glfwGetCursorPos(window, &xpos, &ypos);
+    glm::vec3 rayOrigin, rayDir, hit;
+    ScreenToWorldRay(xpos, ypos, camera, rayOrigin, rayDir);
+    if (!pickScene->Raycast(rayOrigin, rayDir, hit))
+        return;
+
+    bool raise = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS;
+    pickScene->Deform(hit, 0.6f, (raise ? 0.4f : -0.4f) * deltaTime);
+}
+
 // glfw: whenever the mouse moves, this callback is called
 // -------------------------------------------------------
 GameObject* GameObject::movingObject = nullptr;
@@ -107,11 +184,9 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
     {
         glm::vec3 rayOrigin, rayDir;
         ScreenToWorldRay(xposIn, yposIn, camera, rayOrigin, rayDir);
-        float terrainHeight = 0.0f;//因为地面平缓，所以偷懒了
-        float t = (terrainHeight - rayOrigin.y) / rayDir.y;
-        float intersectX = rayOrigin.x + rayDir.x * t;
-        float intersectZ = rayOrigin.z + rayDir.z * t;
-        glm::vec3 newPos = glm::vec3(intersectX, terrainHeight, intersectZ);
+        glm::vec3 newPos;
+        if(!PickGround(rayOrigin, rayDir, newPos))
+            newPos = GameObject::movingObject ? GameObject::movingObject->pos : GameObject::selectedObject->pos;
         if(GameObject::movingObject == nullptr)
         {
             GameObject::movingObject = new GameObject(
@@ -183,12 +258,12 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
 
         if(GameObject::selectedObject != nullptr && GameObject::selectedObject->isGround)
         {
-            float terrainHeight = 0.0f;//因为地面平缓，所以偷懒了
-            float t = (terrainHeight - rayOrigin.y) / rayDir.y;
-            float intersectX = rayOrigin.x + rayDir.x * t;
-            float intersectZ = rayOrigin.z + rayDir.z * t;
-            GameObject::selectedObject->pos = glm::vec3(intersectX, terrainHeight, intersectZ);
-            GameObject::selectedObject->Update();
+            glm::vec3 groundPos;
+            if(PickGround(rayOrigin, rayDir, groundPos))
+            {
+                GameObject::selectedObject->pos = groundPos;
+                GameObject::selectedObject->Update();
+            }
             
             GameObject::selectedObject->Deselect();
             if(GameObject::movingObject != nullptr)
@@ -321,6 +396,7 @@ int main()
 
     //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);//线框模式
     bool last_blinn = false;
+    WaterQuality lastWaterQuality = waterQuality;
     //int framcnt = 0;
     //float startTime = static_cast<float>(glfwGetTime());
     SkyBox skybox(&camera, glm::perspective(glm::radians(camera.Zoom), (float)screenWidth / (float)screenHeight, 0.1f, 100.0f));
@@ -337,10 +413,22 @@ int main()
         return -1;
     }
 
+    // 有大地图时分页加载（.hft 可由 HeightmapFile::WriteTiled 生成），否则可选程序化沙滩；
+    // 两者都不再加载整张高度图
+    TerrainSource terrainSource;
+    std::string pagedPath = FileSystem::getPath("image/coast.hft");
+    if (std::ifstream(pagedPath).good()) {
+        terrainSource.type = TerrainSource::Type::Paged;
+        terrainSource.pagedPath = pagedPath;
+    } else if (proceduralTerrain) {
+        terrainSource.type = TerrainSource::Type::Procedural;
+    }
+
     Scene scene({
         FileSystem::getPath("image/sand_disp.png"),
         FileSystem::getPath("image/sand_diff.jpg")
-        }, 6.0f, 1.0f, 1.0f);
+        }, 6.0f, 1.0f, 1.0f, true, true, terrainSource);
+    pickScene = &scene;
     
     Render renderer(scene, light,
         *(new Framebuffer(screenWidth, screenHeight, false)),
@@ -348,6 +436,11 @@ int main()
         skybox
     );
 
+    // 模型由工作线程并行导入，主线程每帧在预算内上传，物体在模型就绪前不显示
+    ModelLoader modelLoader;
+    GameObject::modelLoader = &modelLoader;
+    const float modelUploadBudgetMs = 4.0f;
+
     // glm::mat4 model = glm::mat4(1.0f);
     glm::vec3 coco_pos = glm::vec3(0.0f, 0.0f, -0.3f);
     glm::vec3 coco_scale = glm::vec3(0.05f, 0.05f, 0.05f);
@@ -389,6 +482,28 @@ int main()
         worldTime += deltaTime * timeScale;
 
         processInput(window);
+        SculptTerrain(window);
+        modelLoader.Update(modelUploadBudgetMs);
+        if (waterQuality != lastWaterQuality)
+        {
+            // 切换档位时以档位的折射方式为准，之后仍可用 R 单独切换
+            renderer.SetWaterQuality(waterQuality);
+            screenSpaceRefraction = (renderer.GetRefractionMode() == RefractionMode::ScreenSpace);
+            lastWaterQuality = waterQuality;
+        }
+        renderer.SetRefractionMode(screenSpaceRefraction ? RefractionMode::ScreenSpace : RefractionMode::Planar);
+        if (temporalWaterUpdate != renderer.GetTemporalAmortization())
+        {
+            // 切换前输出本轮统计
+            const WaterUpdateStats& stats = renderer.GetWaterUpdateStats();
+            std::cout << "Water temporal update: " << (temporalWaterUpdate ? "on" : "off")
+                      << " | rendered " << stats.renderedFrames
+                      << ", skipped " << stats.skippedFrames
+                      << ", reprojection error avg " << stats.avgReprojectionError
+                      << " px, max " << stats.maxReprojectionError << " px" << std::endl;
+            renderer.SetTemporalAmortization(temporalWaterUpdate);
+            renderer.ResetWaterUpdateStats();
+        }
 
         // render
         // ------
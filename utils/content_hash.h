@@ -0,0 +1,39 @@
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <mapped_file.h>
+
+// 内容哈希（FNV-1a 64 位）：各种磁盘缓存的键和纹理共享缓存都用它，
+// 只用来判断内容是否变化，不用于安全场合
+class ContentHash
+{
+public:
+    static uint64_t Hash(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash ^= p[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    static uint64_t HashValue(const T& value, uint64_t hash)
+    {
+        return Hash(&value, sizeof(T), hash);
+    }
+
+    // 文件内容哈希，文件不存在时返回 0
+    static uint64_t HashFile(const std::string& path)
+    {
+        MappedFile file;
+        if (!file.Open(path)) return 0;
+        return Hash(file.Data(), file.Size());
+    }
+};
+
+#endif // CONTENT_HASH_H
@@ -0,0 +1,113 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cmath>
+
+// GPU 计时器：用 GL_TIME_ELAPSED 查询测量一帧的 GPU 耗时
+// 使用环形查询对象，读取几帧前的结果，避免 CPU 等待 GPU
+class GpuTimer
+{
+private:
+    static const int QUERY_COUNT = 4;
+    unsigned int queries[QUERY_COUNT];
+    bool pending[QUERY_COUNT];
+    int current = 0;
+
+public:
+    GpuTimer()
+    {
+        glGenQueries(QUERY_COUNT, queries);
+        for (int i = 0; i < QUERY_COUNT; i++) pending[i] = false;
+    }
+
+    ~GpuTimer()
+    {
+        glDeleteQueries(QUERY_COUNT, queries);
+    }
+
+    void Begin()
+    {
+        glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+    }
+
+    void End()
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        pending[current] = true;
+        current = (current + 1) % QUERY_COUNT;
+    }
+
+    // 取最早一个已完成的查询结果（毫秒），没有可用结果时返回 false
+    bool Poll(float& milliseconds)
+    {
+        int oldest = current;  // 环形缓冲中下一个将被复用的就是最早的
+        if (!pending[oldest]) return false;
+
+        GLint available = 0;
+        glGetQueryObjectiv(queries[oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return false;
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(queries[oldest], GL_QUERY_RESULT, &elapsed);
+        pending[oldest] = false;
+        milliseconds = static_cast<float>(elapsed / 1.0e6);
+        return true;
+    }
+};
+
+// 动态分辨率控制器：根据 GPU 帧时间调整反射/折射缓冲的渲染比例
+// 填充开销与像素数成正比，即与 scale^2 成正比，所以按 sqrt(目标/实际) 缩放
+class DynamicResolutionController
+{
+private:
+    float targetMs;
+    float minScale;
+    float maxScale;
+    float scale;
+    float avgMs = 0.0f;
+    int framesSinceChange = 0;
+
+    const float smoothing = 0.1f;     // 帧时间指数平滑系数
+    const float deadband = 0.08f;     // 目标 ±8% 内不调整，避免来回抖动
+    const float maxStep = 0.1f;       // 单次调整的最大比例变化
+    const int cooldownFrames = 15;    // 两次调整之间的最少帧数
+
+public:
+    DynamicResolutionController(float targetMs = 16.6f, float minScale = 0.25f, float maxScale = 1.0f)
+        : targetMs(targetMs), minScale(minScale), maxScale(maxScale), scale(maxScale)
+    {}
+
+    // 输入一帧 GPU 耗时，返回更新后的比例
+    float Update(float frameMs)
+    {
+        avgMs = (avgMs <= 0.0f) ? frameMs : glm::mix(avgMs, frameMs, smoothing);
+        if (++framesSinceChange < cooldownFrames) return scale;
+
+        float ratio = targetMs / glm::max(avgMs, 0.001f);
+        if (ratio < 1.0f - deadband || ratio > 1.0f + deadband) {
+            float factor = glm::clamp(std::sqrt(ratio), 1.0f - maxStep, 1.0f + maxStep);
+            float newScale = glm::clamp(scale * factor, minScale, maxScale);
+            if (newScale != scale) {
+                scale = newScale;
+                framesSinceChange = 0;
+            }
+        }
+        return scale;
+    }
+
+    void SetTarget(float ms) { targetMs = ms; }
+    void SetRange(float minS, float maxS)
+    {
+        minScale = glm::clamp(minS, 0.25f, 1.0f);
+        maxScale = glm::clamp(maxS, minScale, 1.0f);
+        scale = glm::clamp(scale, minScale, maxScale);
+    }
+
+    float GetScale() const { return scale; }
+    float GetTarget() const { return targetMs; }
+    float GetAverageMs() const { return avgMs; }
+};
+
+#endif // DYNAMIC_RESOLUTION_H
@@ -0,0 +1,56 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+// 视锥体：从 projection * view 矩阵中提取 6 个裁剪平面，用于 CPU 端剔除
+class Frustum
+{
+public:
+    Frustum() {}
+    explicit Frustum(const glm::mat4& viewProj) { Update(viewProj); }
+
+    // Gribb-Hartmann 方法提取平面，法线指向视锥体内部
+    void Update(const glm::mat4& m)
+    {
+        glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+        planes[0] = row3 + row0;  // 左
+        planes[1] = row3 - row0;  // 右
+        planes[2] = row3 + row1;  // 下
+        planes[3] = row3 - row1;  // 上
+        planes[4] = row3 + row2;  // 近
+        planes[5] = row3 - row2;  // 远
+
+        for (int i = 0; i < 6; i++) {
+            float len = glm::length(glm::vec3(planes[i]));
+            if (len > 0.0f) planes[i] /= len;
+        }
+    }
+
+    // AABB 与视锥体相交测试（保守：可能把少量不可见的盒子判为可见）
+    bool IntersectsAABB(const glm::vec3& min, const glm::vec3& max) const
+    {
+        for (int i = 0; i < 6; i++) {
+            // 取沿平面法线方向最远的顶点 (p-vertex)
+            glm::vec3 p(
+                planes[i].x >= 0.0f ? max.x : min.x,
+                planes[i].y >= 0.0f ? max.y : min.y,
+                planes[i].z >= 0.0f ? max.z : min.z
+            );
+            if (glm::dot(glm::vec3(planes[i]), p) + planes[i].w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    const glm::vec4& GetPlane(int i) const { return planes[i]; }
+
+private:
+    glm::vec4 planes[6];
+};
+
+#endif // FRUSTUM_H
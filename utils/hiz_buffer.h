@@ -0,0 +1,129 @@
+#ifndef HIZ_BUFFER_H
+#define HIZ_BUFFER_H
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <iostream>
+#include <shader.h>
+#include <FileSystem.h>
+
+// 层级深度缓冲 (Hi-Z)：第 0 级是屏幕深度，之后每一级取上一级 2x2 的最小深度（最近）
+// 屏幕空间反射用它跳过大片不可能相交的区域
+class HiZBuffer
+{
+private:
+    unsigned int m_texture = 0;
+    unsigned int m_fbo = 0;
+    unsigned int m_vao = 0;
+    int m_width = 0;
+    int m_height = 0;
+    int m_levels = 0;
+    Shader m_shader;
+
+    void Allocate(int width, int height)
+    {
+        if (m_texture) glDeleteTextures(1, &m_texture);
+
+        m_width = width;
+        m_height = height;
+        m_levels = 1;
+        for (int size = std::max(width, height); size > 1; size >>= 1)
+            m_levels++;
+
+        glGenTextures(1, &m_texture);
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        int w = width, h = height;
+        for (int level = 0; level < m_levels; level++)
+        {
+            glTexImage2D(GL_TEXTURE_2D, level, GL_R32F, w, h, 0, GL_RED, GL_FLOAT, nullptr);
+            w = std::max(1, w / 2);
+            h = std::max(1, h / 2);
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_levels - 1);
+
+        std::cout << "HiZ buffer created: " << width << "x" << height
+                  << ", " << m_levels << " levels" << std::endl;
+    }
+
+public:
+    HiZBuffer()
+        : m_shader(FileSystem::getPath("background/hiz.vs").c_str(),
+                   FileSystem::getPath("background/hiz.fs").c_str())
+    {
+        glGenFramebuffers(1, &m_fbo);
+        glGenVertexArrays(1, &m_vao);  // 全屏三角形不需要顶点属性，但核心模式必须绑定 VAO
+    }
+
+    ~HiZBuffer()
+    {
+        if (m_texture) glDeleteTextures(1, &m_texture);
+        glDeleteFramebuffers(1, &m_fbo);
+        glDeleteVertexArrays(1, &m_vao);
+    }
+
+    // 从深度纹理生成整条 mip 链，结束后恢复默认帧缓冲和屏幕视口
+    void Build(unsigned int depthTexture, int width, int height)
+    {
+        if (width != m_width || height != m_height || m_texture == 0)
+            Allocate(width, height);
+
+        GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+        GLboolean blend = glIsEnabled(GL_BLEND);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_BLEND);
+
+        m_shader.use();
+        m_shader.setInt("uSource", 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        glBindVertexArray(m_vao);
+        glActiveTexture(GL_TEXTURE0);
+
+        int srcW = width, srcH = height;
+        for (int level = 0; level < m_levels; level++)
+        {
+            int dstW = level == 0 ? width : std::max(1, srcW / 2);
+            int dstH = level == 0 ? height : std::max(1, srcH / 2);
+
+            if (level == 0) {
+                glBindTexture(GL_TEXTURE_2D, depthTexture);
+                m_shader.setInt("uCopyDepth", 1);
+            } else {
+                // 只让上一级可被采样，避免读写同一级造成反馈循环
+                glBindTexture(GL_TEXTURE_2D, m_texture);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 1);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1);
+                m_shader.setInt("uCopyDepth", 0);
+                m_shader.setIVec2("uSourceSize", srcW, srcH);
+            }
+
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, level);
+            glViewport(0, 0, dstW, dstH);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+
+            if (level > 0) {
+                srcW = dstW;
+                srcH = dstH;
+            }
+        }
+
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_levels - 1);
+
+        glBindVertexArray(0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, width, height);
+        if (depthTest) glEnable(GL_DEPTH_TEST);
+        if (blend) glEnable(GL_BLEND);
+    }
+
+    unsigned int GetTexture() const { return m_texture; }
+    int GetMaxLevel() const { return m_levels - 1; }
+};
+
+#endif // HIZ_BUFFER_H
@@ -0,0 +1,188 @@
+#ifndef IMAGE_DECODE_H
+#define IMAGE_DECODE_H
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#endif
+
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <parallel.h>
+
+// 一批图片的多线程解码与暂存上传：
+// 主线程先用 stbi_info 读出尺寸，分配并映射一个像素缓冲对象（GL_PIXEL_UNPACK_BUFFER）作为暂存区，
+// 各线程解码后直接写入自己的区段；解除映射后 glTexImage2D 从缓冲对象取数据，由驱动异步拷贝，
+// GL 线程只负责上传。映射失败时退回普通内存。
+// 编码字节（通常来自内存映射的文件）在 Decode 返回前必须有效。
+class ImageDecodeBatch
+{
+public:
+    struct Image
+    {
+        std::string name;
+        const unsigned char* encoded = nullptr;
+        size_t encodedSize = 0;
+        int width = 0, height = 0, channels = 0;
+        size_t offset = 0;       // 在暂存区中的位置
+        bool ok = false;
+        float decodeMs = 0.0f;   // 工作线程上的解码耗时
+        float uploadMs = 0.0f;   // GL 线程上的上传耗时
+    };
+
+    ImageDecodeBatch() {}
+    ~ImageDecodeBatch()
+    {
+        if (m_pbo) glDeleteBuffers(1, &m_pbo);
+    }
+
+    ImageDecodeBatch(const ImageDecodeBatch&) = delete;
+    ImageDecodeBatch& operator=(const ImageDecodeBatch&) = delete;
+
+    // 返回图片在本批中的下标
+    int Add(const std::string& name, const unsigned char* encoded, size_t size)
+    {
+        Image image;
+        image.name = name;
+        image.encoded = encoded;
+        image.encodedSize = size;
+        m_images.push_back(image);
+        return static_cast<int>(m_images.size()) - 1;
+    }
+
+    // 主线程调用
+    void Decode()
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        size_t total = 0;
+        for (Image& image : m_images) {
+            if (!image.encoded || !stbi_info_from_memory(image.encoded, static_cast<int>(image.encodedSize),
+                                                         &image.width, &image.height, &image.channels))
+                continue;
+            image.offset = total;
+            total += (Bytes(image) + 15) & ~static_cast<size_t>(15);
+        }
+        if (total == 0) return;
+
+        unsigned char* staging = nullptr;
+        glGenBuffers(1, &m_pbo);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, total, nullptr, GL_STREAM_DRAW);
+        staging = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (!staging) {
+            glDeleteBuffers(1, &m_pbo);
+            m_pbo = 0;
+            m_fallback.resize(total);
+            staging = m_fallback.data();
+        }
+
+        ParallelFor(static_cast<int>(m_images.size()), [&](int i) {
+            Image& image = m_images[i];
+            if (image.width == 0) return;
+            auto t0 = std::chrono::high_resolution_clock::now();
+            // 按 stbi_info 给出的通道数解码，结果大小与暂存区段一致
+            int width, height, channels;
+            unsigned char* data = stbi_load_from_memory(image.encoded, static_cast<int>(image.encodedSize),
+                                                        &width, &height, &channels, image.channels);
+            if (data && width == image.width && height == image.height) {
+                std::memcpy(staging + image.offset, data, Bytes(image));
+                image.ok = true;
+            }
+            stbi_image_free(data);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            image.decodeMs = std::chrono::duration<float, std::milli>(t1 - t0).count();
+        });
+
+        if (m_pbo) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbo);
+            // 映射期间内容丢失（极少见，如显示模式切换）时整批作废
+            if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+                std::cout << "Image staging buffer was lost during decode" << std::endl;
+                for (Image& image : m_images) image.ok = false;
+            }
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        m_decodeWallMs = std::chrono::duration<float, std::milli>(end - start).count();
+    }
+
+    // 把第 i 张图上传到当前绑定纹理的 target（GL_TEXTURE_2D 或立方体贴图的某个面），失败的图返回 false
+    bool Upload(int i, GLenum target)
+    {
+        Image& image = m_images[i];
+        if (!image.ok) return false;
+        auto start = std::chrono::high_resolution_clock::now();
+
+        GLenum format = Format(image.channels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        if (m_pbo) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbo);
+            glTexImage2D(target, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE,
+                         reinterpret_cast<const void*>(image.offset));
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        } else {
+            glTexImage2D(target, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE,
+                         m_fallback.data() + image.offset);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        image.uploadMs = std::chrono::duration<float, std::milli>(end - start).count();
+        return true;
+    }
+
+    const Image& Get(int i) const { return m_images[i]; }
+    int GetCount() const { return static_cast<int>(m_images.size()); }
+
+    // 每张图的解码/上传耗时，以及整批解码的墙钟时间（体现多线程的收益）
+    void Report(const std::string& title) const
+    {
+        float decodeSum = 0.0f, uploadSum = 0.0f;
+        size_t pixelBytes = 0;
+        std::cout << title << ": " << m_images.size() << " image(s)" << std::endl;
+        for (const Image& image : m_images) {
+            std::cout << "  " << image.name;
+            if (image.ok)
+                std::cout << " | " << image.width << "x" << image.height << "x" << image.channels
+                          << " | decode " << image.decodeMs << " ms | upload " << image.uploadMs << " ms";
+            else
+                std::cout << " | failed";
+            std::cout << std::endl;
+            decodeSum += image.decodeMs;
+            uploadSum += image.uploadMs;
+            if (image.ok) pixelBytes += Bytes(image);
+        }
+        std::cout << "  decode " << m_decodeWallMs << " ms wall (" << decodeSum << " ms summed, "
+                  << (m_decodeWallMs > 0.0f ? pixelBytes / (1024.0f * 1024.0f) / (m_decodeWallMs / 1000.0f) : 0.0f)
+                  << " MB/s decoded), upload " << uploadSum << " ms" << std::endl;
+    }
+
+    static GLenum Format(int channels)
+    {
+        if (channels == 1) return GL_RED;
+        if (channels == 2) return GL_RG;
+        if (channels == 3) return GL_RGB;
+        return GL_RGBA;
+    }
+
+private:
+    std::vector<Image> m_images;
+    std::vector<unsigned char> m_fallback;
+    unsigned int m_pbo = 0;
+    float m_decodeWallMs = 0.0f;
+
+    static size_t Bytes(const Image& image)
+    {
+        return static_cast<size_t>(image.width) * image.height * image.channels;
+    }
+};
+
+#endif // IMAGE_DECODE_H
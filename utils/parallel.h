@@ -0,0 +1,46 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+// 把 [0, count) 切成连续的几段，分给多个线程执行 func(begin, end)
+// 每段内部可以复用自己的临时缓冲，适合逐行/逐列的 CPU 烘焙任务
+// maxThreads > 0 时限制线程数（调用方本身已在线程池里时避免超额订阅）
+template <typename Func>
+void ParallelForRange(int count, Func func, int minPerThread = 1, int maxThreads = 0)
+{
+    if (count <= 0) return;
+
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    int limit = hw > 0 ? hw : 4;
+    if (maxThreads > 0) limit = std::min(limit, maxThreads);
+    int threadCount = std::max(1, std::min(limit, count / std::max(1, minPerThread)));
+    if (threadCount == 1) {
+        func(0, count);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    int chunk = (count + threadCount - 1) / threadCount;
+    for (int t = 0; t < threadCount; t++) {
+        int begin = t * chunk;
+        int end = std::min(count, begin + chunk);
+        if (begin >= end) break;
+        threads.emplace_back([=, &func]() { func(begin, end); });
+    }
+    for (auto& th : threads) th.join();
+}
+
+// 逐元素版本：func(i)
+template <typename Func>
+void ParallelFor(int count, Func func, int minPerThread = 1, int maxThreads = 0)
+{
+    ParallelForRange(count, [&func](int begin, int end) {
+        for (int i = begin; i < end; i++) func(i);
+    }, minPerThread, maxThreads);
+}
+
+#endif // PARALLEL_H
@@ -16,6 +16,32 @@
 #include <shader.h>
 #include <gameobject.h>
 #include <cube.h>
+#include <dynamic_resolution.h>
+#include <hiz_buffer.h>
+#include <temporal_update.h>
+#include <occlusion_horizon.h>
+
+// 水面折射的获取方式
+enum class RefractionMode
+{
+    Planar,       // 额外渲染一遍场景到折射缓冲
+    ScreenSpace   // 复用主场景已画好的颜色和深度，省去第二遍场景渲染
+};
+
+// 水面反射的获取方式
+enum class ReflectionMode
+{
+    Planar,       // 镜像相机渲染到反射缓冲（目前只有天空盒）
+    ScreenSpace   // 在主场景的颜色上做 Hi-Z 屏幕空间反射，离开屏幕的光线回退到天空盒
+};
+
+// 水面画质档位，每档对应一组反射/折射方式
+enum class WaterQuality
+{
+    Low,      // 平面反射 + 平面折射
+    Medium,   // 平面反射 + 屏幕空间折射
+    High      // 屏幕空间反射 + 屏幕空间折射
+};
 
 class Render
 {
@@ -32,6 +58,74 @@ private:
     
     float moveFactor = 0.0f;  // 波纹动画因子
 
+    // 反射/折射缓冲的动态分辨率
+    GpuTimer frameTimer;
+    DynamicResolutionController waterResolution;
+    bool dynamicResolution = true;
+
+    // 屏幕空间折射：不透明部分画完后拷贝一份屏幕颜色和深度供水面采样
+    RefractionMode refractionMode = RefractionMode::Planar;
+    Framebuffer* sceneCopyFBO = nullptr;
+
+    // 屏幕空间反射
+    ReflectionMode reflectionMode = ReflectionMode::Planar;
+    HiZBuffer* hizBuffer = nullptr;
+    int ssrMaxSteps = 64;
+    float ssrThickness = 2.0f;
+
+    // 平面反射/折射的分帧更新
+    TemporalUpdatePolicy waterUpdatePolicy;
+    bool temporalAmortization = true;
+    WaterReprojectionParams waterReprojection;
+
+    // 任一效果需要采样主场景时，水面都要在不透明部分之后单独绘制
+    bool UsesSceneCopy() const
+    {
+        return refractionMode == RefractionMode::ScreenSpace || reflectionMode == ReflectionMode::ScreenSpace;
+    }
+
+    // 反射/折射纹理上次渲染时使用的比例（分帧更新时纹理可能是几帧前的）
+    float waterTextureScale = 1.0f;
+
+    // 反射/折射纹理中实际使用的区域比例
+    glm::vec2 GetWaterViewportScale() const
+    {
+        float scale = waterTextureScale;
+        return glm::vec2(
+            Framebuffer::GetScaledSize(refractionFBO.GetWidth(), scale) / (float)refractionFBO.GetWidth(),
+            Framebuffer::GetScaledSize(refractionFBO.GetHeight(), scale) / (float)refractionFBO.GetHeight());
+    }
+
+    // 物体贴地时批量查询地面高度的临时数组，跨帧复用
+    std::vector<float> snapX, snapZ, snapHeight;
+
+    // 地形遮挡剔除：每帧按相机位置算一次，主场景和折射 pass 共用
+    OcclusionHorizon occlusionHorizon;
+    bool horizonCulling = true;
+    std::vector<uint8_t> objectVisible;   // 与 gameObjList 顺序一致
+    std::vector<glm::vec3> cullMin, cullMax;
+
+    void CullObjects(const Camera& camera)
+    {
+        size_t count = GameObject::gameObjList.size();
+        objectVisible.assign(count, 1);
+        // 分页地形没有整张图的 min/max 四叉树，不做地形遮挡剔除
+        if (!horizonCulling || main_scene.GetPagedTerrain() != nullptr)
+            return;
+
+        cullMin.clear();
+        cullMax.clear();
+        for (GameObject* obj : GameObject::gameObjList) {
+            AABB box = obj->GetWorldAABB();
+            cullMin.push_back(box.min);
+            cullMax.push_back(box.max);
+        }
+        occlusionHorizon.Cull(main_scene.GetTerrain()->GetRayCaster(), camera.Position,
+            cullMin.data(), cullMax.data(), count, objectVisible.data());
+    }
+
+    bool IsObjectVisible(size_t i) const { return i >= objectVisible.size() || objectVisible[i]; }
+
     Cube* sunCube = nullptr;
     float currentDayFactor = 1.0f;
 
@@ -141,6 +235,12 @@ public:
         std::vector<Texture> dummyTextures;
         sunCube = new Cube(dummyTextures, main_light.GetLightboxShader());
     }
+
+    ~Render()
+    {
+        delete sceneCopyFBO;
+        delete hizBuffer;
+    }
     
     // 渲染阴影贴图
     void RenderShadowMap(Camera& camera, float screenWidth, float screenHeight)
@@ -156,14 +256,27 @@ public:
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)screenWidth / (float)screenHeight, 0.1f, 10000.0f);
         glm::mat4 view = camera.GetViewMatrix();
         
-        // 渲染所有物体到阴影贴图
+        // 所有物体的地面高度一次批量查询
+        snapX.clear();
+        snapZ.clear();
+        for (GameObject* obj : GameObject::gameObjList) {
+            snapX.push_back(obj->pos.x);
+            snapZ.push_back(obj->pos.z);
+        }
+        snapHeight.resize(snapX.size());
+        main_scene.SampleHeights(snapX.data(), snapZ.data(), snapHeight.data(), snapX.size());
+
+        // 渲染所有物体到阴影贴图（不做地形遮挡剔除：相机看不到的物体，影子仍可能落在可见处）
         auto itr = GameObject::gameObjList.begin();
         for (int i = 0; i < GameObject::gameObjList.size(); i++, ++itr)
         {
             if((*itr)->isSelected && GameObject::movingObject)continue;
-            (*itr)->snaptoterrain(main_scene.GetTerrain());
+            (*itr)->snaptoground(snapHeight[i]);
             (*itr)->Draw(shadowShader,projection,view);
         }
+
+        // 有地平线图时地形自阴影由它提供，这里直接返回；否则（分页地形或没有地平线图）画落在光源视锥内的地形块
+        main_scene.DrawTerrainDepth(lightSpaceMatrix, camera.Position);
         
         glCullFace(GL_BACK);
         shadowMap.Unbind(static_cast<int>(screenWidth), static_cast<int>(screenHeight));  // 恢复到屏幕尺寸
@@ -181,7 +294,7 @@ public:
         Camera reflectCamera(reflectCamPos, -camUp, camera.Yaw, -camera.Pitch);
         glm::mat4 projMatrix = glm::perspective(glm::radians(reflectCamera.Zoom), screenWidth / screenHeight, 0.1f, 100.0f);
 
-        reflectionFBO.Bind();
+        reflectionFBO.Bind(waterTextureScale);
         // glEnable(GL_CLIP_DISTANCE0);
 
         glClearColor(0.5f, 0.7f, 0.9f, 1.0f);  // 天空颜色
@@ -194,11 +307,11 @@ public:
     }
     
     // 渲染折射场景
-    void RenderWaterRefraction(Camera& camera, float screenWidth, float screenHeight)
+    void RenderWaterRefraction(Camera& camera, float screenWidth, float screenHeight, float time = 0.0f)
     {
         float waterHeight = main_scene.GetWaterPlane()->GetHeight();
         
-        refractionFBO.Bind();
+        refractionFBO.Bind(waterTextureScale);
         glEnable(GL_CLIP_DISTANCE0);
 
         glClearColor(0.2f, 0.4f, 0.6f, 1.0f);  // 水下颜色
@@ -209,7 +322,7 @@ public:
             camera,
             screenWidth,
             screenHeight,
-            0.0f,
+            time,  // 焦散动画需要与主场景同步
             glm::vec4(0.0f, -1.0f, 0.0f, waterHeight-50.0f)
         );
         // 渲染所有物体到折射纹理
@@ -219,6 +332,7 @@ public:
         for (int i = 0; i < GameObject::gameObjList.size(); i++, ++itr)
         {
             if((*itr)->isSelected && GameObject::movingObject)continue;
+            if(!IsObjectVisible(i))continue;
             if(camera.Position.y > waterHeight)
             {
                 (*itr)->Draw(model_loadingShader,projection,view, glm::vec4(0, -1, 0, waterHeight));
@@ -234,6 +348,68 @@ public:
         refractionFBO.Unbind(static_cast<int>(screenWidth), static_cast<int>(screenHeight));
     }
     
+    // 画所有物体（主视角，无裁剪）
+    void RenderObjects(Camera& camera, float screenWidth, float screenHeight)
+    {
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)screenWidth / (float)screenHeight, 0.1f, 10000.0f);
+        glm::mat4 view = camera.GetViewMatrix();
+        auto itr = GameObject::gameObjList.begin();
+        main_light.SetLight(model_loadingShader);
+        model_loadingShader.setVec3("viewPos", camera.Position);
+        for (int i = 0; i < GameObject::gameObjList.size(); i++, ++itr)
+        {
+            if((*itr)->isSelected && GameObject::movingObject)continue;
+            if(!IsObjectVisible(i))continue;
+            (*itr)->Draw(model_loadingShader, projection, view);
+        }
+    }
+
+    // 屏幕空间折射/反射：先画完所有不透明物体和天空盒，拷贝屏幕后再画水面
+    void RenderSceneScreenSpace(Camera& camera, float screenWidth, float screenHeight, float time)
+    {
+        int width = static_cast<int>(screenWidth);
+        int height = static_cast<int>(screenHeight);
+        if (sceneCopyFBO == nullptr)
+            sceneCopyFBO = new Framebuffer(width, height, true, true);
+        sceneCopyFBO->Resize(width, height);
+
+        main_scene.DrawTerrain(main_light, camera, screenWidth, screenHeight,
+            shadowMap.GetDepthMap(), main_light.GetLightSpaceMatrix(), time);
+        RenderObjects(camera, screenWidth, screenHeight);
+
+        bool isabove = (camera.Position.y > main_scene.GetWaterPlane()->GetHeight());
+        main_skybox.Render(nullptr, nullptr, isabove, currentDayFactor);
+
+        sceneCopyFBO->CopyFromDefault(width, height);
+
+        ScreenSpaceReflectionParams ssr;
+        if (reflectionMode == ReflectionMode::ScreenSpace)
+        {
+            if (hizBuffer == nullptr)
+                hizBuffer = new HiZBuffer();
+            hizBuffer->Build(sceneCopyFBO->GetDepthTexture(), width, height);
+
+            ssr.enabled = true;
+            ssr.sceneColorTexture = sceneCopyFBO->GetTexture();
+            ssr.hizTexture = hizBuffer->GetTexture();
+            ssr.hizMaxLevel = hizBuffer->GetMaxLevel();
+            ssr.maxSteps = ssrMaxSteps;
+            ssr.thickness = ssrThickness;
+            ssr.skybox = &main_skybox;
+            ssr.dayFactor = currentDayFactor;
+        }
+
+        bool screenSpaceRefraction = (refractionMode == RefractionMode::ScreenSpace);
+        main_scene.DrawWater(main_light, camera, screenWidth, screenHeight, time,
+            reflectionFBO.GetTexture(),
+            screenSpaceRefraction ? sceneCopyFBO->GetTexture() : refractionFBO.GetTexture(),
+            screenSpaceRefraction ? sceneCopyFBO->GetDepthTexture() : refractionFBO.GetDepthTexture(),
+            GetWaterViewportScale(),
+            screenSpaceRefraction ? glm::vec2(1.0f) : GetWaterViewportScale(),
+            &ssr,
+            &waterReprojection);
+    }
+    
     // 渲染完整场景（地形 + 水面）
     void RenderScene(Camera& camera, float screenWidth, float screenHeight, float time = 0.0f)
     {
@@ -244,6 +420,12 @@ public:
 
         glDisable(GL_CLIP_DISTANCE0);
 
+        if (UsesSceneCopy())
+        {
+            RenderSceneScreenSpace(camera, screenWidth, screenHeight, time);
+            return;
+        }
+
         // main_scene.Draw 内部会调用 light.SetLight
         main_scene.Draw(
             main_light,
@@ -256,19 +438,12 @@ public:
             refractionFBO.GetTexture(),      // 折射纹理
             refractionFBO.GetDepthTexture(), // 深度纹理
             shadowMap.GetDepthMap(),         // 阴影贴图
-            main_light.GetLightSpaceMatrix()
+            main_light.GetLightSpaceMatrix(),
+            GetWaterViewportScale(),
+            &waterReprojection
         );
         
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)screenWidth / (float)screenHeight, 0.1f, 10000.0f);
-        glm::mat4 view = camera.GetViewMatrix();
-        auto itr = GameObject::gameObjList.begin();
-        main_light.SetLight(model_loadingShader);
-        model_loadingShader.setVec3("viewPos", camera.Position);
-        for (int i = 0; i < GameObject::gameObjList.size(); i++, ++itr)
-        {
-            if((*itr)->isSelected && GameObject::movingObject)continue;
-            (*itr)->Draw(model_loadingShader, projection, view);
-        }
+        RenderObjects(camera, screenWidth, screenHeight);
 
         bool isabove = (camera.Position.y > main_scene.GetWaterPlane()->GetHeight());
         main_skybox.Render(nullptr, nullptr, isabove, currentDayFactor);
@@ -277,19 +452,116 @@ public:
     // 完整渲染一帧
     void RenderFrame(Camera& camera, float screenWidth, float screenHeight, float time = 0.0f, float worldtime = 0.0f)
     {
+        // 根据前几帧的 GPU 耗时调整反射/折射分辨率
+        float gpuMs;
+        if (frameTimer.Poll(gpuMs) && dynamicResolution)
+            waterResolution.Update(gpuMs);
+        frameTimer.Begin();
+
         // 新增：更新昼夜 & 画太阳立方体
         UpdateDayNight(worldtime, camera);
+
+        // 分页地形的上传/加载队列/淘汰每帧只做一次
+        main_scene.Update(camera);
+
+        // 被沙丘挡住的物体不提交（主场景和折射）
+        CullObjects(camera);
         
-        // 1. 渲染反射
-        RenderWaterReflection(camera, screenWidth, screenHeight);
+        // 平面反射/折射不必每帧都画：相机基本不动时沿用旧纹理，在 water.fs 中重投影
+        waterReprojection = WaterReprojectionParams();
+        bool updateWaterTextures = true;
+        if (temporalAmortization &&
+            (reflectionMode == ReflectionMode::Planar || refractionMode == RefractionMode::Planar))
+        {
+            glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), screenWidth / screenHeight, 0.1f, 10000.0f);
+            glm::mat4 viewProj = projection * camera.GetViewMatrix();
+            bool objectMoving = (GameObject::movingObject != nullptr);
+            updateWaterTextures = waterUpdatePolicy.ShouldUpdate(camera, viewProj,
+                main_scene.GetWaterPlane()->GetHeight(), screenWidth, screenHeight, objectMoving);
+            if (!updateWaterTextures)
+            {
+                waterReprojection.reflection = (reflectionMode == ReflectionMode::Planar);
+                waterReprojection.refraction = (refractionMode == RefractionMode::Planar);
+                waterReprojection.historyViewProj = waterUpdatePolicy.GetHistoryViewProj();
+            }
+        }
+        if (updateWaterTextures)
+            waterTextureScale = waterResolution.GetScale();
+
+        // 1. 渲染反射（屏幕空间反射模式下在主场景中完成）
+        if (reflectionMode == ReflectionMode::Planar && updateWaterTextures)
+            RenderWaterReflection(camera, screenWidth, screenHeight);
         
-        // 2. 渲染折射
-        RenderWaterRefraction(camera, screenWidth, screenHeight);
+        // 2. 渲染折射（屏幕空间折射模式下在主场景中完成）
+        if (refractionMode == RefractionMode::Planar && updateWaterTextures)
+            RenderWaterRefraction(camera, screenWidth, screenHeight, time);
         
         // 3. 渲染主场景（包括水面）
         RenderScene(camera, screenWidth, screenHeight, time);
 
         //main_light.Draw(camera, glm::vec4(0.0f, 1.0f, 0.0f, 1000000.0f));
+
+        frameTimer.End();
+    }
+
+    // 设置动态分辨率的目标 GPU 帧时间（毫秒）
+    void SetTargetFrameTime(float ms) { waterResolution.SetTarget(ms); }
+    // 设置反射/折射缓冲的分辨率比例范围，min == max 时即为固定比例
+    void SetWaterResolutionRange(float minScale, float maxScale) { waterResolution.SetRange(minScale, maxScale); }
+    void SetDynamicResolution(bool enable) { dynamicResolution = enable; }
+    float GetWaterResolutionScale() const { return waterResolution.GetScale(); }
+
+    // 切换方式后平面缓冲里的内容可能已经过时，下一帧强制重画
+    void SetRefractionMode(RefractionMode mode)
+    {
+        if (mode != refractionMode) waterUpdatePolicy.Invalidate();
+        refractionMode = mode;
+    }
+    RefractionMode GetRefractionMode() const { return refractionMode; }
+    void SetReflectionMode(ReflectionMode mode)
+    {
+        if (mode != reflectionMode) waterUpdatePolicy.Invalidate();
+        reflectionMode = mode;
+    }
+    ReflectionMode GetReflectionMode() const { return reflectionMode; }
+    // 屏幕空间反射的最大步数和命中厚度（视空间单位）
+    void SetSSRParams(int maxSteps, float thickness) { ssrMaxSteps = maxSteps; ssrThickness = thickness; }
+
+    // 地形遮挡剔除开关与本帧被剔除的物体数
+    void SetHorizonCulling(bool enable) { horizonCulling = enable; }
+    bool GetHorizonCulling() const { return horizonCulling; }
+    int GetCulledObjectCount() const { return horizonCulling ? occlusionHorizon.GetCulledCount() : 0; }
+
+    // 平面反射/折射的分帧更新：interval 帧内至少更新一次，相机移动/转动超过阈值立即更新
+    void SetTemporalAmortization(bool enable)
+    {
+        temporalAmortization = enable;
+        waterUpdatePolicy.Invalidate();
+    }
+    bool GetTemporalAmortization() const { return temporalAmortization; }
+    void SetWaterUpdateInterval(int frames) { waterUpdatePolicy.SetInterval(frames); }
+    void SetWaterUpdateThresholds(float move, float rotateDegrees) { waterUpdatePolicy.SetThresholds(move, rotateDegrees); }
+    const WaterUpdateStats& GetWaterUpdateStats() const { return waterUpdatePolicy.GetStats(); }
+    void ResetWaterUpdateStats() { waterUpdatePolicy.ResetStats(); }
+
+    void SetWaterQuality(WaterQuality quality)
+    {
+        waterUpdatePolicy.Invalidate();
+        switch (quality)
+        {
+        case WaterQuality::Low:
+            reflectionMode = ReflectionMode::Planar;
+            refractionMode = RefractionMode::Planar;
+            break;
+        case WaterQuality::Medium:
+            reflectionMode = ReflectionMode::Planar;
+            refractionMode = RefractionMode::ScreenSpace;
+            break;
+        case WaterQuality::High:
+            reflectionMode = ReflectionMode::ScreenSpace;
+            refractionMode = RefractionMode::ScreenSpace;
+            break;
+        }
     }
 };
 
@@ -0,0 +1,132 @@
+#ifndef TEMPORAL_UPDATE_H
+#define TEMPORAL_UPDATE_H
+
+#include <glm/glm.hpp>
+#include <camera.h>
+#include <cmath>
+
+// 反射/折射缓冲分帧更新的统计
+struct WaterUpdateStats
+{
+    unsigned long long renderedFrames = 0;   // 重新渲染的帧数
+    unsigned long long skippedFrames = 0;    // 复用旧纹理（重投影）的帧数
+    int framesSinceUpdate = 0;
+    float reprojectionError = 0.0f;          // 当前帧旧纹理的平均重投影偏移（像素）
+    float avgReprojectionError = 0.0f;       // 所有跳过帧的平均值
+    float maxReprojectionError = 0.0f;
+};
+
+// 反射/折射缓冲的更新策略：每 N 帧更新一次，相机移动或转动超过阈值时立即更新，
+// 其余帧沿用旧纹理，由 water.fs 用旧的 view-projection 矩阵重投影
+class TemporalUpdatePolicy
+{
+private:
+    int interval;              // 最多隔多少帧必须更新
+    float moveThreshold;       // 位移阈值（世界单位）
+    float rotateThreshold;     // 朝向变化阈值（度）
+
+    bool hasHistory = false;
+    glm::vec3 lastPosition = glm::vec3(0.0f);
+    glm::vec3 lastFront = glm::vec3(0.0f, 0.0f, -1.0f);
+    float lastZoom = 0.0f;
+    bool lastAbove = true;
+    glm::mat4 lastViewProj = glm::mat4(1.0f);
+
+    WaterUpdateStats stats;
+    double errorSum = 0.0;
+
+    // 在屏幕上取 3x3 个点，求视线与水面的交点，再用旧矩阵投影，统计像素偏移
+    float EstimateReprojectionError(const glm::mat4& viewProj, float waterHeight,
+                                    float screenWidth, float screenHeight) const
+    {
+        glm::mat4 invViewProj = glm::inverse(viewProj);
+        float sum = 0.0f;
+        int count = 0;
+        for (int j = 0; j < 3; j++)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                glm::vec2 ndc(-0.8f + 0.8f * i, -0.8f + 0.8f * j);
+                glm::vec4 nearPoint = invViewProj * glm::vec4(ndc, -1.0f, 1.0f);
+                glm::vec4 farPoint = invViewProj * glm::vec4(ndc, 1.0f, 1.0f);
+                glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+                glm::vec3 dir = glm::vec3(farPoint) / farPoint.w - origin;
+                if (std::abs(dir.y) < 1e-6f) continue;
+
+                float t = (waterHeight - origin.y) / dir.y;
+                if (t < 0.0f || t > 1.0f) continue;  // 这一点看不到水面
+
+                glm::vec4 prevClip = lastViewProj * glm::vec4(origin + dir * t, 1.0f);
+                if (prevClip.w <= 0.0f) continue;
+                glm::vec2 prevNdc = glm::vec2(prevClip) / prevClip.w;
+                glm::vec2 offset = (prevNdc - ndc) * 0.5f * glm::vec2(screenWidth, screenHeight);
+                sum += glm::length(offset);
+                count++;
+            }
+        }
+        return count > 0 ? sum / count : 0.0f;
+    }
+
+public:
+    TemporalUpdatePolicy(int interval = 4, float moveThreshold = 0.5f, float rotateThreshold = 2.0f)
+        : interval(interval), moveThreshold(moveThreshold), rotateThreshold(rotateThreshold)
+    {}
+
+    // 判断本帧是否需要重新渲染反射/折射缓冲；返回 false 时 GetHistoryViewProj() 为旧纹理对应的矩阵
+    bool ShouldUpdate(const Camera& camera, const glm::mat4& viewProj, float waterHeight,
+                      float screenWidth, float screenHeight, bool forceUpdate = false)
+    {
+        bool above = camera.Position.y > waterHeight;
+
+        bool update = forceUpdate || !hasHistory || interval <= 1;
+        if (!update)
+        {
+            float cosAngle = glm::clamp(glm::dot(glm::normalize(camera.Front), lastFront), -1.0f, 1.0f);
+            update = stats.framesSinceUpdate + 1 >= interval
+                || glm::length(camera.Position - lastPosition) > moveThreshold
+                || glm::degrees(std::acos(cosAngle)) > rotateThreshold
+                || camera.Zoom != lastZoom
+                || above != lastAbove;   // 穿过水面时折射内容完全不同
+        }
+
+        if (update)
+        {
+            hasHistory = true;
+            lastPosition = camera.Position;
+            lastFront = glm::normalize(camera.Front);
+            lastZoom = camera.Zoom;
+            lastAbove = above;
+            lastViewProj = viewProj;
+            stats.renderedFrames++;
+            stats.framesSinceUpdate = 0;
+            stats.reprojectionError = 0.0f;
+            return true;
+        }
+
+        stats.skippedFrames++;
+        stats.framesSinceUpdate++;
+        stats.reprojectionError = EstimateReprojectionError(viewProj, waterHeight, screenWidth, screenHeight);
+        errorSum += stats.reprojectionError;
+        stats.avgReprojectionError = static_cast<float>(errorSum / stats.skippedFrames);
+        stats.maxReprojectionError = glm::max(stats.maxReprojectionError, stats.reprojectionError);
+        return false;
+    }
+
+    // 下一帧强制更新（例如切换渲染模式之后）
+    void Invalidate() { hasHistory = false; }
+
+    void SetInterval(int frames) { interval = frames < 1 ? 1 : frames; }
+    void SetThresholds(float move, float rotateDegrees) { moveThreshold = move; rotateThreshold = rotateDegrees; }
+
+    const glm::mat4& GetHistoryViewProj() const { return lastViewProj; }
+    const WaterUpdateStats& GetStats() const { return stats; }
+    void ResetStats()
+    {
+        int since = stats.framesSinceUpdate;
+        stats = WaterUpdateStats();
+        stats.framesSinceUpdate = since;
+        errorSum = 0.0;
+    }
+};
+
+#endif // TEMPORAL_UPDATE_H
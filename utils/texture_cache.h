@@ -0,0 +1,137 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <glad/glad.h>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <iostream>
+#include <content_hash.h>
+
+// 进程内共享的纹理缓存：按图像内容哈希（加上纹理目标和采样参数）索引，
+// 同一张图不论被哪个模型、哪个目录下的同名文件引用，都只解码、上传一次，共用一个 GL 纹理，按引用计数释放。
+//
+// Acquire 只查表、加引用，不调用 GL，可以在工作线程里先查，命中就跳过解码；
+// Insert / Release 会创建或删除 GL 对象，只能在主线程调用。
+class TextureCache
+{
+public:
+    // 参与缓存键的纹理状态，内容相同但参数不同的纹理各自独立
+    struct Sampler
+    {
+        int target, wrapS, wrapT, minFilter, magFilter;
+    };
+
+    // 模型纹理使用的参数
+    static Sampler ModelSampler()
+    {
+        return { GL_TEXTURE_2D, GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR };
+    }
+
+    static TextureCache& Instance()
+    {
+        static TextureCache cache;
+        return cache;
+    }
+
+    // 缓存键：内容哈希（编码后的文件字节或原始像素）+ 采样参数
+    static uint64_t Key(const void* data, size_t size, const Sampler& sampler)
+    {
+        return ContentHash::Hash(&sampler, sizeof(sampler), ContentHash::Hash(data, size));
+    }
+
+    // 已有同一内容的纹理时增加引用并返回它，否则返回 0
+    unsigned int Acquire(uint64_t key)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it == m_entries.end()) return 0;
+        it->second.refs++;
+        m_hits++;
+        m_savedBytes += it->second.bytes;
+        return it->second.id;
+    }
+
+    // 登记新上传的纹理（引用计数为 1）。同一内容已被别处先登记时删除新纹理，返回已有的那个
+    unsigned int Insert(uint64_t key, unsigned int id, size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            glDeleteTextures(1, &id);
+            it->second.refs++;
+            m_hits++;
+            m_savedBytes += it->second.bytes;
+            return it->second.id;
+        }
+        m_entries[key] = { id, 1, bytes };
+        m_keys[id] = key;
+        m_residentBytes += bytes;
+        return id;
+    }
+
+    // 引用归零时删除纹理；不在缓存中的纹理直接删除
+    void Release(unsigned int id)
+    {
+        if (id == 0) return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto keyIt = m_keys.find(id);
+        if (keyIt == m_keys.end()) {
+            glDeleteTextures(1, &id);
+            return;
+        }
+        auto it = m_entries.find(keyIt->second);
+        if (--it->second.refs > 0) return;
+        m_residentBytes -= it->second.bytes;
+        m_entries.erase(it);
+        m_keys.erase(keyIt);
+        glDeleteTextures(1, &id);
+    }
+
+    // 含 mipmap 的显存估算
+    static size_t EstimateBytes(int width, int height, int channels, bool mipmaps = true)
+    {
+        size_t bytes = static_cast<size_t>(width) * height * channels;
+        return mipmaps ? bytes * 4 / 3 : bytes;
+    }
+
+    // 统计
+    int GetTextureCount()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return static_cast<int>(m_entries.size());
+    }
+    size_t GetResidentBytes()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_residentBytes;
+    }
+
+    void PrintStats()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::cout << "Texture cache: " << m_entries.size() << " unique textures, "
+                  << m_residentBytes / (1024.0f * 1024.0f) << " MB | " << m_hits << " shared hits saved "
+                  << m_savedBytes / (1024.0f * 1024.0f) << " MB" << std::endl;
+    }
+
+private:
+    struct Entry
+    {
+        unsigned int id;
+        int refs;
+        size_t bytes;
+    };
+
+    std::mutex m_mutex;
+    std::unordered_map<uint64_t, Entry> m_entries;
+    std::unordered_map<unsigned int, uint64_t> m_keys;   // GL 纹理 -> 缓存键，释放时使用
+    size_t m_residentBytes = 0;
+    size_t m_savedBytes = 0;
+    int m_hits = 0;
+
+    TextureCache() {}
+};
+
+#endif // TEXTURE_CACHE_H